@@ -40,6 +40,7 @@ static int initial_producers = 1;
 static int nchildren = 10;
 static int maxdepth  = 2000;
 static int bouncing  = 0;
+static int scatter   = 1;
 static int verbose   = 0;
 static gtc_qtype_t qtype = GtcQueueSAWS;
 
@@ -83,6 +84,10 @@ void create_task(gtc_t gtc, task_class_t tclass, int level, int index, int ntask
   tt->nconsumers_key = nconsumers_key;
 
 #ifdef NO_INPLACE
+  // producers feed everyone else, take and steal them ahead of consumers (with GTC_PRIORITIES > 1)
+  if (tclass == producer_tclass)
+    gtc_task_set_priority(task, 1);
+
 #ifdef PUSHING
   gtc_add(gtc, task, index % nproc);
 #else
@@ -96,6 +101,42 @@ void create_task(gtc_t gtc, task_class_t tclass, int level, int index, int ntask
 }
 
 
+/**
+ * Spread the initial producers over every process.  Collective call, rank 0 creates all of
+ * them and gtc_scatter() hands each process its share before processing starts.
+ *
+ * @param gtc            The task collection to enqueue the tasks into
+ * @param ntasks_key     The CLO key that is used to look up the task counter
+ * @param nproducers_key The CLO key that is used to look up the producer counter
+ * @param nconsumers_key The CLO key that is used to look up the consumer counter
+**/
+void scatter_producers(gtc_t gtc, int ntasks_key, int nproducers_key, int nconsumers_key) {
+  int      n     = (me == 0) ? initial_producers : 0;
+  task_t **tasks = malloc((n > 0 ? n : 1) * sizeof(task_t *));
+
+  for (int i = 0; i < n; i++) {
+    pctask_t *tt;
+
+    tasks[i] = gtc_task_create(producer_tclass);
+    gtc_task_set_priority(tasks[i], 1);
+
+    tt = (pctask_t*) gtc_task_body(tasks[i]);
+    tt->parent_id      = me;
+    tt->level          = 0;
+    tt->index          = i;
+    tt->ntasks_key     = ntasks_key;
+    tt->nproducers_key = nproducers_key;
+    tt->nconsumers_key = nconsumers_key;
+  }
+
+  gtc_scatter(gtc, tasks, n);
+
+  for (int i = 0; i < n; i++)
+    gtc_task_destroy(tasks[i]);
+  free(tasks);
+}
+
+
 /**
  * This function implements the task and is called when the task is executed.
  *
@@ -156,7 +197,7 @@ void process_args(int argc, char **argv) {
   int   arg;
   char *endptr;
 
-  while ((arg = getopt(argc, argv, "d:n:r:p:c:i:bvhBH")) != -1) {
+  while ((arg = getopt(argc, argv, "d:n:r:p:c:i:bsvhBHL")) != -1) {
     switch (arg) {
     case 'd':
       maxdepth = strtol(optarg, &endptr, 10);
@@ -202,6 +243,10 @@ void process_args(int argc, char **argv) {
       bouncing = 1;
       break;
 
+    case 's':
+      scatter = 0;
+      break;
+
     case 'v':
       verbose = 1;
       break;
@@ -212,6 +257,9 @@ void process_args(int argc, char **argv) {
     case 'H':
       qtype = GtcQueueSAWS;
       break;
+    case 'L':
+      qtype = GtcQueueSDCLF;
+      break;
 
     case 'h':
       if (me == 0) {
@@ -224,7 +272,9 @@ void process_args(int argc, char **argv) {
         printf("  -p dbl   %5.2f  Producer work size (units of %.2f ms)\n", producer_work_units, work_time);
         printf("  -c dbl   %5.2f  Consumer work size (units of %.2f ms)\n", consumer_work_units, work_time);
         printf("  -b              Enable bouncing mode\n");
+        printf("  -s              Seed every initial producer on process 0 instead of scattering them\n");
         printf("  -v              Enable verbose output\n");
+        printf("  -B/-H/-L        SDC, SAWS or lock-free SDC queue\n");
         printf("  -h              Help\n");
       }
       exit(0);
@@ -289,9 +339,11 @@ int main(int argc, char **argv) {
   producer_tclass = gtc_task_class_register(sizeof(pctask_t), producer_task_fcn); // Collectively create a task class
   consumer_tclass = gtc_task_class_register(sizeof(pctask_t), consumer_task_fcn); // Collectively create a task class
 
-  // Add the initial producer tasks to the task collection
-  // FIXME: these are going to all get stuck on one process due to SMP-awareness
-  if (me == 0) {
+  // Add the initial producer tasks to the task collection, spread over all processes unless
+  // we were asked to leave them on process 0 and let stealing disperse them
+  if (scatter) {
+    scatter_producers(gtc, ntasks_key, nproducers_key, nconsumers_key);
+  } else if (me == 0) {
     int i;
     for (i = 0; i < initial_producers; i++)
       create_task(gtc, producer_tclass, 0, i, ntasks_key, nproducers_key, nconsumers_key);
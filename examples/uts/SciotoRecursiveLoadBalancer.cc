@@ -19,6 +19,7 @@ static task_class_t task_class;
 static int me, nproc;
 
 extern gtc_qtype_t qtype;
+extern int         target_selection;
 int walklen = 1;
 
 void strict_dfs_task_fcn(gtc_t gtc, task_t *parent) {
@@ -87,6 +88,7 @@ double ldbal_scioto(UTSIterator iter) {
   // Initialize the Task Collection
   gtc_ldbal_cfg_t cfg;
   gtc_ldbal_cfg_init(&cfg);
+  cfg.target_selection = target_selection;
 
   gtc_t         gtc        = gtc_create(sizeof(UTSIterator), 10, UTS_QUEUE_SIZE, &cfg, qtype);
   task_t       *parent     = gtc_task_create(task_class);
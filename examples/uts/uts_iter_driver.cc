@@ -13,6 +13,7 @@
 #include "RecursiveLoadBalancers.h"
 
 gtc_qtype_t qtype = GtcQueueSDC;
+int         target_selection = TARGET_RANDOM;
 
 /***********************************************************
  *  UTS Implementation Hooks                               *
@@ -49,16 +50,34 @@ int  impl_parseParam(char *param, char *value) {
         qtype = GtcQueueSAWS;
         ret = 0;
         break;
+      case 'L':
+      case 'N':
+        qtype = GtcQueueSDCLF;
+        ret = 0;
+        break;
       default:
-        printf("-Q: unknown queue type must be one of 'B' 'N' or 'H'\n");
+        printf("-Q: unknown queue type must be one of 'B' 'N' 'H' or 'L'\n");
         break;
     }
+  } else if (param[1] == 'V') {
+    const char *policies = "ROXPST";
+    const char *p        = strchr(policies, value[0]);
+
+    if (value[0] != '\0' && p != NULL) {
+      target_selection = p - policies;
+      ret = 0;
+    } else {
+      printf("-V: unknown victim selection policy must be one of 'R' 'O' 'X' 'P' 'S' or 'T'\n");
+    }
   }
   return ret;
 }
 
 void impl_helpMessage() {
-  printf("   none.\n");
+  printf("   -Q  char  queue type (B: SDC, H: SAWS, L: SDC with lock-free steals,\n");
+  printf("             N: same as L)\n");
+  printf("   -V  char  victim selection (R: random, O: round robin, X: xorshift, P: permutation,\n");
+  printf("             S: sticky, T: two choice)\n");
 }
 
 void impl_abort(int err) {
@@ -13,6 +13,14 @@
 
 #include "tc.h"
 #include "saws_shrb.h"
+#include "inbox.h"
+
+/*
+ * Bytes a task actually uses, variable-length queues store only this much.
+ */
+static int gtc_task_len_saws(void *e) {
+  return sizeof(task_t) + gtc_task_body_size((task_t *)e);
+}
 
 /**
  * Create a new task collection.  Collective call.
@@ -27,16 +35,25 @@
 gtc_t gtc_create_saws(gtc_t gtc, int max_body_size, int shrb_size, gtc_ldbal_cfg_t *cfg) {
   GTC_ENTRY();
   tc_t  *tc;
+  char  *pipe;
 
   UNUSED(max_body_size);
   UNUSED(cfg);
 
   tc  = gtc_lookup(gtc);
 
-  // Allocate the shared ring buffer.  Total task size is the size
+  // Allocate a shared ring buffer for each priority level.  Total task size is the size
   // of the header + max_body size.
-  tc->shared_rb = saws_shrb_create(tc->max_body_size + sizeof(task_t), shrb_size, tc);
-  tc->inbox = NULL;
+  //
+  // stolen tasks land in our own queue, so we can start on the first one while the
+  // rest of the steal is in flight
+  pipe = getenv("GTC_SAWS_PIPELINE");
+  for (int l = 0; l < tc->npriorities; l++) {
+    tc->prio_rb[l] = saws_shrb_create(tc->max_body_size + sizeof(task_t), shrb_size, tc);
+    ((saws_shrb_t *)tc->prio_rb[l])->pipeline = pipe ? atoi(pipe) : 1;
+    ((saws_shrb_t *)tc->prio_rb[l])->elem_len = gtc_task_len_saws;
+  }
+  tc->shared_rb = tc->prio_rb[0];
 
   tc->cb.destroy                = gtc_destroy_saws;
   tc->cb.reset                  = gtc_reset_saws;
@@ -53,8 +70,11 @@ gtc_t gtc_create_saws(gtc_t gtc, int max_body_size, int shrb_size, gtc_ldbal_cfg
   tc->rcb.pop_head               = saws_shrb_pop_head;
   tc->rcb.pop_n_tail             = saws_shrb_pop_n_tail;
   tc->rcb.try_pop_n_tail         = saws_shrb_try_pop_n_tail;
+  tc->rcb.steal_n_tail           = saws_shrb_steal_n_tail;
+  tc->rcb.try_steal_n_tail       = saws_shrb_try_steal_n_tail;
   tc->rcb.push_n_head            = saws_shrb_push_n_head;
   tc->rcb.work_avail             = saws_shrb_size;
+  tc->rcb.probe_n                = saws_shrb_probe_n;
 
   tc->qsize = sizeof(saws_shrb_t);
 
@@ -72,7 +92,8 @@ void gtc_destroy_saws(gtc_t gtc) {
   GTC_ENTRY();
   tc_t *tc = gtc_lookup(gtc);
 
-  saws_shrb_destroy(tc->shared_rb);
+  for (int l = 0; l < tc->npriorities; l++)
+    saws_shrb_destroy(tc->prio_rb[l]);
   GTC_EXIT();
 }
 
@@ -85,7 +106,17 @@ void gtc_destroy_saws(gtc_t gtc) {
 void gtc_reset_saws(gtc_t gtc) {
   GTC_ENTRY();
   tc_t *tc = gtc_lookup(gtc);
-  saws_shrb_reset(tc->shared_rb);
+
+  // every thief's last steal completion has to land before anyone clears their queue
+  for (int l = 0; l < tc->npriorities; l++) {
+    saws_shrb_t *rb = tc->prio_rb[l];
+    saws_shrb_steal_finish(rb);
+    shmem_ctx_quiet(rb->ctx);
+  }
+  shmem_barrier_all();
+
+  for (int l = 0; l < tc->npriorities; l++)
+    saws_shrb_reset(tc->prio_rb[l]);
   GTC_EXIT();
 }
 
@@ -110,31 +141,32 @@ void gtc_progress_saws(gtc_t gtc) {
   static int cc = 0;
   TC_START_TIMER(tc,progress);
 
-#if 0 /* no task pushing */
-  // Check the inbox for new work
-  if (shrb_size(tc->inbox) > 0) {
-    int   ntasks, npopped;
-    void *work;
+  // Finish any pipelined steal once its first task has been taken
+  for (int l = 0; l < tc->npriorities; l++)
+    if (saws_shrb_local_isempty(tc->prio_rb[l]))
+      saws_shrb_steal_finish(tc->prio_rb[l]);
 
-    ntasks = 100;
-    work   = gtc_malloc((tc->max_body_size+sizeof(task_t))*ntasks);
-    npopped= shrb_pop_n_tail(tc->inbox, _c->rank, ntasks, work, STEAL_CHUNK);
+  // Send our batched remote adds and move anything pushed to us onto our queue
+  gtc_inbox_flush(tc->inbox);
+  gtc_inbox_drain(tc->inbox);
 
-    saws_shrb_push_n_head(tc->shrb, _c->rank, work, npopped);
-    shrb_free(work);
+  // Hand part of our work to any lifeline buddies waiting on us before releasing the rest
+  gtc_lifeline_push(gtc);
 
-    gtc_lprintf(DBGINBOX, "gtc_progress: Moved %d tasks from inbox to my queue\n", npopped);
-  }
-#endif /* no task pushing */
+  for (int l = 0; l < tc->npriorities; l++) {
+    // Move spilled tasks back into the ring as space frees up
+    saws_shrb_refill(tc->prio_rb[l]);
 
-  // Update the split
-  if (saws_shrb_size(tc->shared_rb) > 1)
-    saws_shrb_release(tc->shared_rb);
+    // Update the split
+    if (saws_shrb_size(tc->prio_rb[l]) > 1)
+      saws_shrb_release(tc->prio_rb[l]);
+  }
 
   // Attempt to reclaim space
   if ((cc++ % ((saws_shrb_t *)tc->shared_rb)->reclaimfreq) == 0)
-    saws_shrb_reclaim_space(tc->shared_rb);
-  ((saws_shrb_t *)tc->shared_rb)->nprogress++;
+    for (int l = 0; l < tc->npriorities; l++)
+      saws_shrb_reclaim_space(tc->prio_rb[l]);
+  ((saws_shrb_t *)tc->shared_rb)->stats->nprogress++;
   TC_STOP_TIMER(tc,progress);
   GTC_EXIT();
 }
@@ -148,9 +180,25 @@ void gtc_progress_saws(gtc_t gtc) {
 int gtc_tasks_avail_saws(gtc_t gtc) {
   GTC_ENTRY();
   tc_t *tc = gtc_lookup(gtc);
+  int   n  = gtc_inbox_size(tc->inbox);
 
-  //return saws_shrb_size(tc->shrb) + shrb_size(tc->inbox);
-  GTC_EXIT(saws_shrb_size(tc->shared_rb));
+  for (int l = 0; l < tc->npriorities; l++)
+    n += saws_shrb_size(tc->prio_rb[l]);
+
+  GTC_EXIT(n);
+}
+
+
+
+/*
+ * Steal from v's highest priority level that has work, returns the number of tasks stolen.
+ */
+static inline int gtc_steal_levels_saws(gtc_t gtc, tc_t *tc, int v) {
+  int n = 0;
+
+  for (int l = tc->npriorities-1; l >= 0 && n <= 0; l--)
+    n = gtc_steal_tail(gtc, v, l);
+  return n;
 }
 
 
@@ -184,10 +232,12 @@ int gtc_get_buf_saws(gtc_t gtc, int priority, task_t *buf) {
   GTC_ENTRY();
   tc_t   *tc = gtc_lookup(gtc);
   int     got_task = 0;
-  int     v, steal_size;
+  int     v, steal_size, level, avail;
   int     passive = 0;
   int     searching = 0;
+  int     lifeline = 0;
   gtc_vs_state_t vs_state = {0, 0, 0};
+  gtc_idle_state_t idle = {0, 0};
 
   tc->ct.getcalls++;
   TC_START_TIMER(tc, getbuf);
@@ -224,23 +274,43 @@ int gtc_get_buf_saws(gtc_t gtc, int priority, task_t *buf) {
         searching = 1;
       }
 
-      // Select the next target
-      v = gtc_select_target(gtc, &vs_state);
+      // Out of luck stealing, stop and wait for a lifeline buddy to push work to us
+      if (!lifeline && tc->ldbal_cfg.lifeline_after > 0 && idle.nfails >= tc->ldbal_cfg.lifeline_after) {
+        gtc_lifeline_register(gtc);
+        lifeline = 1;
+      }
 
-      tc->state = STATE_STEALING;
+      if (!lifeline) {
+        if (tc->ldbal_cfg.probe_width > 1) {
+          // Probe several targets at once and steal from the one with the most work
+          v = gtc_probe_victims(gtc, &vs_state, &level, &avail);
 
-      // attempt remote steal
-      steal_size = gtc_steal_tail(gtc, v);
-      // Steal succeeded: Got some work from remote node
-      if (steal_size > 0) {
-        tc->ct.tasks_stolen += steal_size;
-        tc->ct.num_steals += 1;
-        tc->last_target = v;
-        searching = 1;
+          tc->state = STATE_STEALING;
 
-        // Steal failed: Got the lock, no longer any work on remote node
-      } else {
-        tc->ct.failed_steals_unlocked++;
+          steal_size = (v >= 0) ? gtc_steal_tail(gtc, v, level) : 0;
+
+        } else {
+          // Select the next target
+          v = gtc_select_target(gtc, &vs_state);
+
+          tc->state = STATE_STEALING;
+
+          // attempt remote steal
+          steal_size = gtc_steal_levels_saws(gtc, tc, v);
+        }
+
+        // Steal succeeded: Got some work from remote node
+        if (steal_size > 0) {
+          tc->ct.tasks_stolen += steal_size;
+          tc->ct.num_steals += 1;
+          tc->last_target = v;
+          searching = 1;
+          idle.nfails = idle.npause = 0;
+
+          // Steal failed: Got the lock, no longer any work on remote node
+        } else {
+          tc->ct.failed_steals_unlocked++;
+        }
       }
 
       // Invoke the progress engine
@@ -253,10 +323,18 @@ int gtc_get_buf_saws(gtc_t gtc, int priority, task_t *buf) {
         td_set_counters(tc->td, tc->ct.tasks_spawned, tc->ct.tasks_completed);
         tc->terminated = td_attempt_vote(tc->td);
 
+        // Nothing left to steal, sleep until the next vote or a lifeline push
+        if (lifeline && !tc->terminated)
+          td_wait(tc->td);
+
       // We have work, done stealing
       } else if (gtc_tasks_avail(gtc)) {
         got_task = gtc_get_local_buf(gtc, priority, buf);
       }
+
+      // Still nothing, back off before the next steal
+      if (!got_task && !tc->terminated)
+        gtc_idle_wait(gtc, &idle);
     } //end whileloop for td
 
   } else {
@@ -272,7 +350,7 @@ int gtc_get_buf_saws(gtc_t gtc, int priority, task_t *buf) {
   // Record how many attempts it took for our first get, this is the number of
   // attempts during the work dispersion phase.
   if (!tc->dispersed) {
-    //if (passive) TC_STOP_TIMER(tc, dispersion);
+    if (passive) TC_STOP_TIMER(tc, dispersion);
     tc->dispersed = 1;
     tc->ct.dispersion_attempts_unlocked = tc->ct.failed_steals_unlocked;
     tc->ct.dispersion_attempts_locked   = tc->ct.failed_steals_locked;
@@ -312,18 +390,13 @@ int gtc_add_saws(gtc_t gtc, task_t *task, int proc) {
   task->created_by = _c->rank;
 
   if (proc == _c->rank) {
-    // Local add: put it straight onto the local work list
-    saws_shrb_push_head(tc->shared_rb, _c->rank, task, sizeof(task_t) + gtc_task_body_size(task));
+    // Local add: put it straight onto the local work list for its priority level
+    saws_shrb_push_head(tc->prio_rb[gtc_task_level(tc, task)], _c->rank, task, sizeof(task_t) + gtc_task_body_size(task));
   }
-#if 0 /* no task pushing */
   else {
-    // Remote adds: put this in the remote node's inbox
-    if (task->affinity == 0)
-      shrb_push_head(tc->inbox, proc, task, sizeof(task_t) + gtc_task_body_size(task));
-    else
-      shrb_push_tail(tc->inbox, proc, task, sizeof(task_t) + gtc_task_body_size(task));
+    // Remote adds: batch it up for the remote process's inbox
+    gtc_inbox_push(tc->inbox, proc, task, sizeof(task_t) + gtc_task_body_size(task));
   }
-#endif /* no task pushing */
 
   ++tc->ct.tasks_spawned;
   TC_STOP_TIMER(tc,add);
@@ -337,6 +410,7 @@ int gtc_add_saws(gtc_t gtc, task_t *task, int proc) {
  * have finished.  The pointer returned points directly to an element in the
  * queue.  Do not add it, do not free it, discard the pointer when you are finished
  * assigning the task body.
+ * In-place tasks are always queued at priority level 0.
  *
  * @param gtc    Portable reference to the task collection
  * @param tclass Desired task class
@@ -355,6 +429,7 @@ task_t *gtc_task_inplace_create_and_add_saws(gtc_t gtc, task_class_t tclass) {
   t->created_by = _c->rank;
   //t->affinity   = 0;
   t->priority   = 0;
+  t->cost       = 0;
 
   ++tc->ct.tasks_spawned;
 
@@ -385,6 +460,37 @@ void gtc_task_inplace_create_and_add_finish_saws(gtc_t gtc, task_t *t) {
 }
 
 
+/*
+ * Sum the queue counters over every priority level, the spill high water mark is the largest
+ * of any level.
+ */
+static void gtc_saws_queue_stats(tc_t *tc, saws_shrb_stats_t *stats, int *spill_hwm) {
+  memset(stats, 0, sizeof(*stats));
+  *spill_hwm = 0;
+
+  for (int l = 0; l < tc->npriorities; l++) {
+    saws_shrb_t *rb = tc->prio_rb[l];
+
+    stats->nwaited      += rb->stats->nwaited;
+    stats->ndeferred    += rb->stats->ndeferred;
+    stats->nreclaimed   += rb->stats->nreclaimed;
+    stats->nreccalls    += rb->stats->nreccalls;
+    stats->nrelease     += rb->stats->nrelease;
+    stats->nprogress    += rb->stats->nprogress;
+    stats->nreacquire   += rb->stats->nreacquire;
+    stats->ngets        += rb->stats->ngets;
+    stats->nensure      += rb->stats->nensure;
+    stats->nxfer        += rb->stats->nxfer;
+    stats->nsteals      += rb->stats->nsteals;
+    stats->nmeta        += rb->stats->nmeta;
+    stats->nspilled     += rb->stats->nspilled;
+    stats->nlocalsteals += rb->stats->nlocalsteals;
+    if (rb->spill_hwm > *spill_hwm)
+      *spill_hwm = rb->spill_hwm;
+  }
+}
+
+
 /**
  * Print stats for this task collection.
  * @param tc       IN Ptr to task collection
@@ -393,31 +499,41 @@ void gtc_print_stats_saws(gtc_t gtc) {
   GTC_ENTRY();
   tc_t *tc = gtc_lookup(gtc);
   saws_shrb_t *rb = tc->shared_rb;
+  saws_shrb_stats_t stats;
+  int spill_hwm;
 
   uint64_t perget, peradd, perinplace, perfinish, perprogress, perreclaim, perensure, perrelease, perreacquire, perpoptail;
+  uint64_t persteal, perstealdone;
 
   if (!getenv("SCIOTO_DISABLE_STATS") && !getenv("SCIOTO_DISABLE_PERNODE_STATS")) {
+    gtc_saws_queue_stats(tc, &stats, &spill_hwm);
+
     // avoid floating point exceptions...
     perget       = tc->ct.getcalls      != 0 ? TC_READ_TIMER(tc,getbuf)    / tc->ct.getcalls      : 0;
     peradd       = tc->ct.tasks_spawned != 0 ? TC_READ_TIMER(tc,add)       / tc->ct.tasks_spawned : 0;
     perinplace   = tc->ct.tasks_spawned != 0 ? TC_READ_TIMER(tc,addinplace)/ tc->ct.tasks_spawned : 0; // borrowed
-    perfinish    = rb->nprogress     != 0 ? TC_READ_TIMER(tc,addfinish) / rb->nprogress     : 0; // borrowed, but why?
-    perprogress  = rb->nprogress     != 0 ? TC_READ_TIMER(tc,progress)  / rb->nprogress     : 0;
-    perreclaim   = rb->nreccalls     != 0 ? TC_READ_TIMER(tc,reclaim)   / rb->nreccalls     : 0;
-    perensure    = rb->nensure       != 0 ? TC_READ_TIMER(tc,ensure)    / rb->nensure       : 0;
-    perrelease   = rb->nrelease      != 0 ? TC_READ_TIMER(tc,release)   / rb->nrelease      : 0;
-    perreacquire = rb->nreacquire    != 0 ? TC_READ_TIMER(tc,reacquire) / rb->nreacquire    : 0;
-    perpoptail   = rb->ngets         != 0 ? TC_READ_TIMER(tc,poptail)   / rb->ngets         : 0;
-
-    printf(" %4d - saws-Q: nrelease %6lu, nreacquire %6lu, nreclaimed %6lu, nwaited %2lu, nprogress %6lu\n"
+    perfinish    = stats.nprogress     != 0 ? TC_READ_TIMER(tc,addfinish) / stats.nprogress     : 0; // borrowed, but why?
+    perprogress  = stats.nprogress     != 0 ? TC_READ_TIMER(tc,progress)  / stats.nprogress     : 0;
+    perreclaim   = stats.nreccalls     != 0 ? TC_READ_TIMER(tc,reclaim)   / stats.nreccalls     : 0;
+    perensure    = stats.nensure       != 0 ? TC_READ_TIMER(tc,ensure)    / stats.nensure       : 0;
+    perrelease   = stats.nrelease      != 0 ? TC_READ_TIMER(tc,release)   / stats.nrelease      : 0;
+    perreacquire = stats.nreacquire    != 0 ? TC_READ_TIMER(tc,reacquire) / stats.nreacquire    : 0;
+    perpoptail   = stats.ngets         != 0 ? TC_READ_TIMER(tc,poptail)   / stats.ngets         : 0;
+    persteal     = stats.nsteals       != 0 ? TC_READ_TIMER(tc,poptail)   / stats.nsteals       : 0;
+    perstealdone = stats.nsteals       != 0 ? TC_READ_TIMER(tc,stealdone) / stats.nsteals       : 0;
+
+    printf(" %4d - saws-Q: nrelease %6lu, nreacquire %6lu, nreclaimed %6lu, nwaited %2lu, ndeferred %2lu, nprogress %6lu\n"
            " %4d -    failed w/lock: %6lu, failed w/o lock: %6lu, aborted steals: %6lu\n"
-           " %4d -    ngets: %6lu  (%5.2f usec/get) nxfer: %6lu\n",
+           " %4d -    ngets: %6lu  (%5.2f usec/get) nxfer: %6lu\n"
+           " %4d -    spilled: %6lu  spill hwm: %6d\n",
       _c->rank,
-        rb->nrelease, rb->nreacquire, rb->nreclaimed, rb->nwaited, rb->nprogress,
+        stats.nrelease, stats.nreacquire, stats.nreclaimed, stats.nwaited, stats.ndeferred, stats.nprogress,
       _c->rank,
         tc->ct.failed_steals_locked, tc->ct.failed_steals_unlocked, tc->ct.aborted_steals,
       _c->rank,
-        rb->ngets, TC_READ_TIMER_USEC(tc, t[0])/(double)rb->ngets, rb->nxfer);
+        stats.ngets, TC_READ_TIMER_USEC(tc, t[0])/(double)stats.ngets, stats.nxfer,
+      _c->rank,
+        stats.nspilled, spill_hwm);
     printf(" %4d - TSC: get: %"PRIu64"M (%"PRIu64" x %"PRIu64")  add: %"PRIu64"M (%"PRIu64" x %"PRIu64") inplace: %"PRIu64"M (%"PRIu64")\n",
         _c->rank,
         TC_READ_TIMER_M(tc,getbuf), perget, tc->ct.getcalls,
@@ -426,18 +542,21 @@ void gtc_print_stats_saws(gtc_t gtc) {
     printf(" %4d - TSC: addfinish: %"PRIu64"M (%"PRIu64") progress: %"PRIu64"M (%"PRIu64" x %"PRIu64") reclaim: %"PRIu64"M (%"PRIu64" x %"PRIu64")\n",
         _c->rank,
         TC_READ_TIMER_M(tc,addfinish), perfinish,
-        TC_READ_TIMER_M(tc,progress), perprogress, rb->nprogress,
-        TC_READ_TIMER_M(tc,reclaim), perreclaim, rb->nreccalls);
+        TC_READ_TIMER_M(tc,progress), perprogress, stats.nprogress,
+        TC_READ_TIMER_M(tc,reclaim), perreclaim, stats.nreccalls);
     printf(" %4d - TSC: ensure: %"PRIu64"M (%"PRIu64" x %"PRIu64") release: %"PRIu64"M (%"PRIu64" x %"PRIu64") "
            "reacquire: %"PRIu64"M (%"PRIu64" x %"PRIu64")\n",
         _c->rank,
-        TC_READ_TIMER_M(tc,ensure), perensure, rb->nensure,
-        TC_READ_TIMER_M(tc,release), perrelease, rb->nrelease,
-        TC_READ_TIMER_M(tc,reacquire), perreacquire, rb->nreacquire);
+        TC_READ_TIMER_M(tc,ensure), perensure, stats.nensure,
+        TC_READ_TIMER_M(tc,release), perrelease, stats.nrelease,
+        TC_READ_TIMER_M(tc,reacquire), perreacquire, stats.nreacquire);
     printf(" %4d - TSC: pushhead: %"PRIu64"M (%"PRIu64") poptail: %"PRIu64"M (%"PRIu64" x %"PRIu64")\n",
         _c->rank,
         TC_READ_TIMER_M(tc,pushhead), (uint64_t)0,
-        TC_READ_TIMER_M(tc,poptail), perpoptail, rb->ngets);
+        TC_READ_TIMER_M(tc,poptail), perpoptail, stats.ngets);
+    printf(" %4d - TSC: steal latency (%s): first task %"PRIu64" completion %"PRIu64" (x %"PRIu64")\n",
+        _c->rank, rb->pipeline ? "pipelined" : "blocking",
+        persteal, perstealdone, stats.nsteals);
   }
   GTC_EXIT();
 }
@@ -452,21 +571,25 @@ void gtc_print_gstats_saws(gtc_t gtc) {
   GTC_ENTRY();
   tc_t *tc = gtc_lookup(gtc);
   saws_shrb_t *rb = (saws_shrb_t *)tc->shared_rb;
+  saws_shrb_stats_t stats;
+  int spill_hwm;
   double   *times, *mintimes, *maxtimes, *sumtimes;
   uint64_t *counts, *mincounts, *maxcounts, *sumcounts;
 
-  int ntimes = 16;
+  int ntimes = 22;
   times     = gtc_shmem_calloc(ntimes, sizeof(double));
   mintimes  = gtc_shmem_calloc(ntimes, sizeof(double));
   maxtimes  = gtc_shmem_calloc(ntimes, sizeof(double));
   sumtimes  = gtc_shmem_calloc(ntimes, sizeof(double));
 
-  int ncounts = 13;
+  int ncounts = 18;
   counts     = gtc_shmem_calloc(ncounts, sizeof(uint64_t));
   mincounts  = gtc_shmem_calloc(ncounts, sizeof(uint64_t));
   maxcounts  = gtc_shmem_calloc(ncounts, sizeof(uint64_t));
   sumcounts  = gtc_shmem_calloc(ncounts, sizeof(uint64_t));
 
+  gtc_saws_queue_stats(tc, &stats, &spill_hwm);
+
 
   times[SAWSPopTailTime]        = TC_READ_TIMER_MSEC(tc,poptail);
   times[SAWSGetMetaTime]        = TC_READ_TIMER_MSEC(tc,getmeta);
@@ -474,29 +597,40 @@ void gtc_print_gstats_saws(gtc_t gtc) {
   times[SAWSReclaimTime]        = TC_READ_TIMER_USEC(tc,reclaim);
   times[SAWSEnsureTime]         = TC_READ_TIMER_USEC(tc,ensure);
   times[SAWSReacquireTime]      = TC_READ_TIMER_MSEC(tc,reacquire);
+  times[SAWSReacqWaitTime]      = TC_READ_TIMER_USEC(tc,reacqwait);
+  times[SAWSReacqDeferTime]     = TC_READ_TIMER_USEC(tc,reacqdefer);
   times[SAWSReleaseTime]        = TC_READ_TIMER_USEC(tc,release);
-  times[SAWSPerPopTailTime]     = rb->ngets         != 0 ? TC_READ_TIMER_MSEC(tc,poptail)   / rb->ngets         : 0.0;
-  times[SAWSPerGetMetaTime]     = rb->nmeta         != 0 ? TC_READ_TIMER_MSEC(tc,getmeta)   / rb->nmeta         : 0.0;
-  times[SAWSPerProgressTime]    = rb->nprogress     != 0 ? TC_READ_TIMER_USEC(tc,progress)  / rb->nprogress     : 0.0;
-  times[SAWSPerReclaimTime]     = rb->nreccalls     != 0 ? TC_READ_TIMER_USEC(tc,reclaim)   / rb->nreccalls     : 0.0;
-  times[SAWSPerEnsureTime]      = rb->nensure       != 0 ? TC_READ_TIMER_USEC(tc,ensure)    / rb->nensure       : 0.0;
-  times[SAWSPerReacquireTime]   = rb->nreacquire    != 0 ? TC_READ_TIMER_MSEC(tc,reacquire) / rb->nreacquire    : 0.0;
-  times[SAWSPerReleaseTime]     = rb->nrelease      != 0 ? TC_READ_TIMER_USEC(tc,release)   / rb->nrelease      : 0.0;
-  times[14]			= TC_READ_TIMER_USEC(tc, t[0]);
-  times[15]			= TC_READ_TIMER_USEC(tc, t[1]);
-  counts[SAWSNumGets]            = rb->ngets;
+  times[SAWSPerPopTailTime]     = stats.ngets         != 0 ? TC_READ_TIMER_MSEC(tc,poptail)   / stats.ngets         : 0.0;
+  times[SAWSPerGetMetaTime]     = stats.nmeta         != 0 ? TC_READ_TIMER_MSEC(tc,getmeta)   / stats.nmeta         : 0.0;
+  times[SAWSPerProgressTime]    = stats.nprogress     != 0 ? TC_READ_TIMER_USEC(tc,progress)  / stats.nprogress     : 0.0;
+  times[SAWSPerReclaimTime]     = stats.nreccalls     != 0 ? TC_READ_TIMER_USEC(tc,reclaim)   / stats.nreccalls     : 0.0;
+  times[SAWSPerEnsureTime]      = stats.nensure       != 0 ? TC_READ_TIMER_USEC(tc,ensure)    / stats.nensure       : 0.0;
+  times[SAWSPerReacquireTime]   = stats.nreacquire    != 0 ? TC_READ_TIMER_MSEC(tc,reacquire) / stats.nreacquire    : 0.0;
+  times[SAWSPerReacqWaitTime]   = stats.nwaited       != 0 ? TC_READ_TIMER_USEC(tc,reacqwait) / stats.nwaited       : 0.0;
+  times[SAWSPerReacqDeferTime]  = stats.ndeferred     != 0 ? TC_READ_TIMER_USEC(tc,reacqdefer)/ stats.ndeferred     : 0.0;
+  times[SAWSPerReleaseTime]     = stats.nrelease      != 0 ? TC_READ_TIMER_USEC(tc,release)   / stats.nrelease      : 0.0;
+  times[SAWSPerStealTime]       = stats.nsteals       != 0 ? TC_READ_TIMER_USEC(tc,poptail)   / stats.nsteals       : 0.0;
+  times[SAWSPerStealDoneTime]   = stats.nsteals       != 0 ? TC_READ_TIMER_USEC(tc,stealdone) / stats.nsteals       : 0.0;
+  times[20]			= TC_READ_TIMER_USEC(tc, t[0]);
+  times[21]			= TC_READ_TIMER_USEC(tc, t[1]);
+  counts[SAWSNumGets]            = stats.ngets;
   counts[SAWSGetCalls]           = tc->ct.getcalls;
-  counts[SAWSNumMeta]            = rb->nmeta;
+  counts[SAWSNumMeta]            = stats.nmeta;
   counts[SAWSGetLocalCalls]      = tc->ct.getlocal;
-  counts[SAWSNumSteals]          = rb->nsteals;
+  counts[SAWSNumSteals]          = stats.nsteals;
   counts[SAWSStealFailsLocked]   = tc->ct.failed_steals_locked;
   counts[SAWSStealFailsUnlocked] = tc->ct.failed_steals_unlocked;
   counts[SAWSAbortedSteals]      = tc->ct.aborted_steals;
-  counts[SAWSProgressCalls]      = rb->nprogress;
-  counts[SAWSReclaimCalls]       = rb->nreccalls;
-  counts[SAWSEnsureCalls]        = rb->nensure;
-  counts[SAWSReacquireCalls]     = rb->nreacquire;
-  counts[SAWSReleaseCalls]       = rb->nrelease;
+  counts[SAWSProgressCalls]      = stats.nprogress;
+  counts[SAWSReclaimCalls]       = stats.nreccalls;
+  counts[SAWSEnsureCalls]        = stats.nensure;
+  counts[SAWSReacquireCalls]     = stats.nreacquire;
+  counts[SAWSReacquireStalls]    = stats.nwaited;
+  counts[SAWSReacquireDeferred]  = stats.ndeferred;
+  counts[SAWSReleaseCalls]       = stats.nrelease;
+  counts[SAWSSpilled]            = stats.nspilled;
+  counts[SAWSSpillHWM]           = spill_hwm;
+  counts[SAWSLocalSteals]        = stats.nlocalsteals;
 
   shmem_min_reduce(SHMEM_TEAM_WORLD, mintimes, times, ntimes);
   shmem_max_reduce(SHMEM_TEAM_WORLD, maxtimes, times, ntimes);
@@ -514,6 +648,11 @@ void gtc_print_gstats_saws(gtc_t gtc) {
       sumtimes[SAWSPopTailTime]/_c->size, mintimes[SAWSPopTailTime], maxtimes[SAWSPopTailTime],
       sumtimes[SAWSPerPopTailTime]/_c->size, mintimes[SAWSPerPopTailTime], maxtimes[SAWSPerPopTailTime]);
 
+  eprintf("        :   latency    %s first task %6.2fus/%6.2fus/%6.2fus completion %6.2fus/%6.2fus/%6.2fus\n",
+      rb->pipeline ? "pipelined" : "blocking ",
+      sumtimes[SAWSPerStealTime]/_c->size, mintimes[SAWSPerStealTime], maxtimes[SAWSPerStealTime],
+      sumtimes[SAWSPerStealDoneTime]/_c->size, mintimes[SAWSPerStealDoneTime], maxtimes[SAWSPerStealDoneTime]);
+
   eprintf("        :   get_buf    %6lu (%6.2f/%3lu/%3lu\n",
       sumcounts[SAWSGetCalls], sumcounts[SAWSGetCalls]/(double)_c->size, mincounts[SAWSGetCalls], maxcounts[SAWSGetCalls]);
 
@@ -528,6 +667,10 @@ void gtc_print_gstats_saws(gtc_t gtc) {
   eprintf("        :   steals     %6lu (%6.2f/%3lu/%3lu)\n",
       sumcounts[SAWSNumSteals], sumcounts[SAWSNumSteals]/(double)_c->size,
       mincounts[SAWSNumSteals], maxcounts[SAWSNumSteals]);
+  eprintf("        :   on-node    %6lu (%6.2f/%3lu/%3lu) off-node %6lu\n",
+      sumcounts[SAWSLocalSteals], sumcounts[SAWSLocalSteals]/(double)_c->size,
+      mincounts[SAWSLocalSteals], maxcounts[SAWSLocalSteals],
+      sumcounts[SAWSNumSteals] - sumcounts[SAWSLocalSteals]);
   eprintf("        :   fails lock %6lu (%6.2f/%3lu/%3lu)\n",
       sumcounts[SAWSStealFailsLocked], sumcounts[SAWSStealFailsLocked]/(double)_c->size,
       mincounts[SAWSStealFailsLocked], maxcounts[SAWSStealFailsLocked]);
@@ -554,11 +697,26 @@ void gtc_print_gstats_saws(gtc_t gtc) {
       sumcounts[SAWSReacquireCalls]/(double)_c->size, mincounts[SAWSReacquireCalls], maxcounts[SAWSReacquireCalls],
       sumtimes[SAWSReacquireTime]/_c->size, mintimes[SAWSReacquireTime], maxtimes[SAWSReacquireTime],
       sumtimes[SAWSPerReacquireTime]/_c->size, mintimes[SAWSPerReacquireTime], maxtimes[SAWSPerReacquireTime]);
+  eprintf("        :   stalls     %6lu (%6.2f/%3lu/%3lu) time %6.2fus/%6.2fus/%6.2fus per %6.2fus/%6.2fus/%6.2fus\n",
+      sumcounts[SAWSReacquireStalls], sumcounts[SAWSReacquireStalls]/(double)_c->size,
+      mincounts[SAWSReacquireStalls], maxcounts[SAWSReacquireStalls],
+      sumtimes[SAWSReacqWaitTime]/_c->size, mintimes[SAWSReacqWaitTime], maxtimes[SAWSReacqWaitTime],
+      sumtimes[SAWSPerReacqWaitTime]/_c->size, mintimes[SAWSPerReacqWaitTime], maxtimes[SAWSPerReacqWaitTime]);
+  eprintf("        :   deferred   %6lu (%6.2f/%3lu/%3lu) time %6.2fus/%6.2fus/%6.2fus per %6.2fus/%6.2fus/%6.2fus\n",
+      sumcounts[SAWSReacquireDeferred], sumcounts[SAWSReacquireDeferred]/(double)_c->size,
+      mincounts[SAWSReacquireDeferred], maxcounts[SAWSReacquireDeferred],
+      sumtimes[SAWSReacqDeferTime]/_c->size, mintimes[SAWSReacqDeferTime], maxtimes[SAWSReacqDeferTime],
+      sumtimes[SAWSPerReacqDeferTime]/_c->size, mintimes[SAWSPerReacqDeferTime], maxtimes[SAWSPerReacqDeferTime]);
   eprintf("        : release    %6.2f/%3lu/%3lu time %6.2fus/%6.2fus/%6.2fus per %6.2fus/%6.2fus/%6.2fus\n",
       sumcounts[SAWSReleaseCalls]/(double)_c->size, mincounts[SAWSReleaseCalls], maxcounts[SAWSReleaseCalls],
       sumtimes[SAWSReleaseTime]/_c->size, mintimes[SAWSReleaseTime], maxtimes[SAWSReleaseTime],
       sumtimes[SAWSPerReleaseTime]/_c->size, mintimes[SAWSPerReleaseTime], maxtimes[SAWSPerReleaseTime]);
 
+  eprintf("        : spilled    %6lu (%6.2f/%3lu/%3lu) high-water %6lu/%3lu\n",
+      sumcounts[SAWSSpilled], sumcounts[SAWSSpilled]/(double)_c->size,
+      mincounts[SAWSSpilled], maxcounts[SAWSSpilled],
+      mincounts[SAWSSpillHWM], maxcounts[SAWSSpillHWM]);
+
   eprintf("&&&  %6.2f %6.2f ", sumtimes[SAWSPopTailTime]/_c->size, sumtimes[SAWSReacquireTime]/_c->size);
 
   shmem_free(times);
@@ -584,15 +742,13 @@ void gtc_queue_reset_saws(gtc_t gtc) {
   tc_t *tc = gtc_lookup(gtc);
 
   // Clear out the ring buffer
-  saws_shrb_lock(tc->shared_rb, _c->rank);
-  saws_shrb_reset(tc->shared_rb);
-  saws_shrb_unlock(tc->shared_rb, _c->rank);
+  for (int l = 0; l < tc->npriorities; l++) {
+    saws_shrb_lock(tc->prio_rb[l], _c->rank);
+    saws_shrb_reset(tc->prio_rb[l]);
+    saws_shrb_unlock(tc->prio_rb[l], _c->rank);
+  }
 
-#if 0 /* no task pushing */
   // Clear out the inbox
-  shrb_lock(tc->inbox, _c->rank);
-  shrb_reset(tc->inbox);
-  shrb_unlock(tc->inbox, _c->rank);
-#endif /* no task pushing */
+  gtc_inbox_clear(tc->inbox);
   GTC_EXIT();
 }
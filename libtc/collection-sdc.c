@@ -14,6 +14,7 @@
 #include "tc.h"
 
 #include "sdc_shr_ring.h"
+#include "inbox.h"
 //#include "shr_ring.h"
 
 /**
@@ -35,11 +36,11 @@ gtc_t gtc_create_sdc(gtc_t gtc, int max_body_size, int shrb_size, gtc_ldbal_cfg_
 
   tc  = gtc_lookup(gtc);
 
-  // Allocate the shared ring buffer.  Total task size is the size
+  // Allocate a shared ring buffer for each priority level.  Total task size is the size
   // of the header + max_body size.
-  tc->shared_rb = sdc_shrb_create(tc->max_body_size + sizeof(task_t), shrb_size, tc);
-  //tc->inbox = shrb_create(tc->max_body_size + sizeof(task_t), shrb_size);
-  tc->inbox = NULL;
+  for (int l = 0; l < tc->npriorities; l++)
+    tc->prio_rb[l] = sdc_shrb_create(tc->max_body_size + sizeof(task_t), shrb_size, tc);
+  tc->shared_rb = tc->prio_rb[0];
 
   tc->cb.destroy                = gtc_destroy_sdc;
   tc->cb.reset                  = gtc_reset_sdc;
@@ -49,15 +50,18 @@ gtc_t gtc_create_sdc(gtc_t gtc, int max_body_size, int shrb_size, gtc_ldbal_cfg_
   tc->cb.inplace_ca_finish      = gtc_task_inplace_create_and_add_finish_sdc;
   tc->cb.progress               = gtc_progress_sdc;
   tc->cb.tasks_avail            = gtc_tasks_avail_sdc;
-  tc->cb.queue_name             = gtc_queue_name_sdc;
+  tc->cb.queue_name             = tc->qtype == GtcQueueSDCLF ? gtc_queue_name_sdclf : gtc_queue_name_sdc;
   tc->cb.print_stats            = gtc_print_stats_sdc;
   tc->cb.print_gstats           = gtc_print_gstats_sdc;
 
   tc->rcb.pop_head               = sdc_shrb_pop_head;
   tc->rcb.pop_n_tail             = sdc_shrb_pop_n_tail;
   tc->rcb.try_pop_n_tail         = sdc_shrb_try_pop_n_tail;
+  tc->rcb.steal_n_tail           = sdc_shrb_steal_n_tail;
+  tc->rcb.try_steal_n_tail       = sdc_shrb_try_steal_n_tail;
   tc->rcb.push_n_head            = sdc_shrb_push_n_head;
   tc->rcb.work_avail             = sdc_shrb_size;
+  tc->rcb.probe_n                = sdc_shrb_probe_n;
 
   tc->qsize = sizeof(sdc_shrb_t);
 
@@ -75,7 +79,8 @@ void gtc_destroy_sdc(gtc_t gtc) {
   GTC_ENTRY();
   tc_t *tc = gtc_lookup(gtc);
 
-  sdc_shrb_destroy(tc->shared_rb);
+  for (int l = 0; l < tc->npriorities; l++)
+    sdc_shrb_destroy(tc->prio_rb[l]);
   GTC_EXIT();
 }
 
@@ -88,7 +93,8 @@ void gtc_destroy_sdc(gtc_t gtc) {
 void gtc_reset_sdc(gtc_t gtc) {
   GTC_ENTRY();
   tc_t *tc = gtc_lookup(gtc);
-  sdc_shrb_reset(tc->shared_rb);
+  for (int l = 0; l < tc->npriorities; l++)
+    sdc_shrb_reset(tc->prio_rb[l]);
   GTC_EXIT();
 }
 
@@ -108,6 +114,16 @@ char *gtc_queue_name_sdc() {
 
 
 
+/**
+ * String that gives the name of the lock-free variant of this queue
+ */
+char *gtc_queue_name_sdclf() {
+  GTC_ENTRY();
+  GTC_EXIT("Split Deferred-Copy (lock-free)");
+}
+
+
+
 /** Invoke the progress engine.  Update work queues, balance the schedule,
  *  make progress on communication.
  */
@@ -116,29 +132,24 @@ void gtc_progress_sdc(gtc_t gtc) {
   tc_t *tc = gtc_lookup(gtc);
   TC_START_TIMER(tc,progress);
 
-#if 0 /* no task pushing */
-  // Check the inbox for new work
-  if (shrb_size(tc->inbox) > 0) {
-    int   ntasks, npopped;
-    void *work;
+  // Send our batched remote adds and move anything pushed to us onto our queue
+  gtc_inbox_flush(tc->inbox);
+  gtc_inbox_drain(tc->inbox);
 
-    ntasks = 100;
-    work   = gtc_malloc((tc->max_body_size+sizeof(task_t))*ntasks);
-    npopped= shrb_pop_n_tail(tc->inbox, _c->rank, ntasks, work, STEAL_CHUNK);
+  // Hand part of our work to any lifeline buddies waiting on us before releasing the rest
+  gtc_lifeline_push(gtc);
 
-    sdc_shrb_push_n_head(tc->shared_rb, _c->rank, work, npopped);
-    shrb_free(work);
+  for (int l = 0; l < tc->npriorities; l++) {
+    // Move spilled tasks back into the ring as space frees up
+    sdc_shrb_refill(tc->prio_rb[l]);
 
-    gtc_lprintf(DBGINBOX, "gtc_progress: Moved %d tasks from inbox to my queue\n", npopped);
-  }
-#endif /* no task pushing */
+    // Update the split
+    sdc_shrb_release(tc->prio_rb[l]);
 
-  // Update the split
-  sdc_shrb_release(tc->shared_rb);
-
-  // Attempt to reclaim space
-  sdc_shrb_reclaim_space(tc->shared_rb);
-  ((sdc_shrb_t *)tc->shared_rb)->nprogress++;
+    // Attempt to reclaim space
+    sdc_shrb_reclaim_space(tc->prio_rb[l]);
+  }
+  ((sdc_shrb_t *)tc->shared_rb)->stats->nprogress++;
   TC_STOP_TIMER(tc,progress);
   GTC_EXIT();
 }
@@ -152,9 +163,30 @@ void gtc_progress_sdc(gtc_t gtc) {
 int gtc_tasks_avail_sdc(gtc_t gtc) {
   GTC_ENTRY();
   tc_t *tc = gtc_lookup(gtc);
+  int   n  = gtc_inbox_size(tc->inbox);
 
-  //return sdc_shrb_size(tc->shared_rb) + shrb_size(tc->inbox);
-  GTC_EXIT(sdc_shrb_size(tc->shared_rb));
+  for (int l = 0; l < tc->npriorities; l++)
+    n += sdc_shrb_size(tc->prio_rb[l]);
+
+  GTC_EXIT(n);
+}
+
+
+
+/*
+ * Probe v's queues from the highest priority level down, returns the metadata of the first
+ * level with shared work (or of level 0 if none has any) and sets level to match.
+ */
+static inline uint64_t gtc_probe_levels_sdc(tc_t *tc, int v, int *level) {
+  uint64_t meta = 0;
+
+  for (*level = tc->npriorities-1; *level >= 0; (*level)--) {
+    meta = sdc_shrb_probe(tc->prio_rb[*level], v);
+    if (sdc_meta_shared_size(meta) > 0)
+      return meta;
+  }
+  *level = 0;
+  return meta;
 }
 
 
@@ -170,17 +202,17 @@ int gtc_tasks_avail_sdc(gtc_t gtc) {
  *                 found.  A NULL result here means that global termination
  *                 has occurred.  Returned buffer should be deleted by the user.
  */
-double gtc_get_dummy_work = 0.0;
-
 int gtc_get_buf_sdc(gtc_t gtc, int priority, task_t *buf) {
   GTC_ENTRY();
   tc_t   *tc = gtc_lookup(gtc);
   int     got_task = 0;
-  int     v, steal_size;
+  int     v, steal_size, level, avail;
   int     passive = 0;
   int     searching = 0;
+  int     lifeline = 0;
   gtc_vs_state_t vs_state = {0, 0, 0};
-  sdc_shrb_t rb_buf;
+  gtc_idle_state_t idle = {0, 0};
+  uint64_t meta;
 
   tc->ct.getcalls++;
   TC_START_TIMER(tc, getbuf);
@@ -212,7 +244,6 @@ int gtc_get_buf_sdc(gtc_t gtc, int priority, task_t *buf) {
     // Keep searching until we find work or detect termination
     while (!got_task && !tc->terminated) {
       int      max_steal_attempts, steal_attempts, steal_done;
-      void *target_rb = &rb_buf;
 
       tc->state = STATE_SEARCHING;
 
@@ -221,93 +252,135 @@ int gtc_get_buf_sdc(gtc_t gtc, int priority, task_t *buf) {
         searching = 1;
       }
 
-      // Select the next target
-      v = gtc_select_target(gtc, &vs_state);
-
-      max_steal_attempts = tc->ldbal_cfg.max_steal_attempts_remote;
+      // Out of luck stealing, stop and wait for a lifeline buddy to push work to us
+      if (!lifeline && tc->ldbal_cfg.lifeline_after > 0 && idle.nfails >= tc->ldbal_cfg.lifeline_after) {
+        gtc_lifeline_register(gtc);
+        lifeline = 1;
+      }
 
-      TC_START_TIMER(tc,poptail); // this counts as attempting to steal
-      shmem_getmem(target_rb, tc->shared_rb, sizeof(sdc_shrb_t), v);
-      TC_STOP_TIMER(tc,poptail);
+      if (lifeline) {
+        gtc_progress(gtc);
 
-      // Poll the target for work.  In between polls, maintain progress on termination detection.
-      for (steal_attempts = 0, steal_done = 0;
-           !steal_done && !tc->terminated && steal_attempts < max_steal_attempts;
-           steal_attempts++) {
+        if (gtc_tasks_avail(gtc) == 0 && !tc->external_work_avail) {
+          td_set_counters(tc->td, tc->ct.tasks_spawned, tc->ct.tasks_completed);
+          tc->terminated = td_attempt_vote(tc->td);
 
-        // Apply linear backoff to avoid flooding remote nodes
-        if (steal_attempts > 0) {
-          int j;
-          for (j = 0; j < steal_attempts*1000; j++)
-            gtc_get_dummy_work += 1.0;
+          // Nothing left to steal, sleep until the next vote or a lifeline push
+          if (!tc->terminated)
+            td_wait(tc->td);
         }
 
-        if (tc->rcb.work_avail(target_rb) > 0) {
-          tc->state = STATE_STEALING;
+      } else {
+        TC_START_TIMER(tc,poptail); // this counts as attempting to steal
+        if (tc->ldbal_cfg.probe_width > 1) {
+          // Probe several targets at once and go after the one with the most work
+          v = gtc_probe_victims(gtc, &vs_state, &level, &avail);
 
-          if (searching) {
-#ifndef NO_SEATBELTS
-            TC_STOP_TIMER(tc, search);
-#endif
-            searching = 0;
-          }
+        } else {
+          // Select the next target
+          v = gtc_select_target(gtc, &vs_state);
+          meta = gtc_probe_levels_sdc(tc, v, &level);
+          avail = sdc_meta_shared_size(meta);
+          gtc_victim_observe(tc, v, avail);
+        }
+        TC_STOP_TIMER(tc,poptail);
 
-          // Perform a steal/try_steal
-          if (tc->ldbal_cfg.steals_can_abort)
-            steal_size = gtc_try_steal_tail(gtc, v);
-          else
-            steal_size = gtc_steal_tail(gtc, v);
+        // On-node victims are cheap to poll, so they get a bigger budget before we move on
+        if (v >= 0 && tc->on_node[v])
+          max_steal_attempts = tc->ldbal_cfg.max_steal_attempts_local;
+        else
+          max_steal_attempts = tc->ldbal_cfg.max_steal_attempts_remote;
 
-          // Steal succeeded: Got some work from remote node
-          if (steal_size > 0) {
-            tc->ct.tasks_stolen += steal_size;
-            tc->ct.num_steals += 1;
-            steal_done = 1;
-            tc->last_target = v;
+        // Poll the target for work.  In between polls, maintain progress on termination detection.
+        for (steal_attempts = 0, steal_done = 0;
+             !steal_done && !tc->terminated && steal_attempts < max_steal_attempts;
+             steal_attempts++) {
 
-          // Steal failed: Got the lock, no longer any work on remote node
-          } else if (steal_size == 0) {
-            tc->ct.failed_steals_locked++;
-            steal_done = 1;
+          // Back off before retrying an aborted steal to avoid flooding the target
+          if (steal_attempts > 0)
+            gtc_idle_wait(gtc, &idle);
 
-          // Steal aborted: Didn't get the lock, refresh target metadata and try again
-          } else {
-            if (steal_attempts + 1 == max_steal_attempts)
+          if (avail > 0) {
+            tc->state = STATE_STEALING;
+
+            if (searching) {
+#ifndef NO_SEATBELTS
+              TC_STOP_TIMER(tc, search);
+#endif
+              searching = 0;
+            }
+
+            // Perform a steal/try_steal
+            if (tc->ldbal_cfg.steals_can_abort)
+              steal_size = gtc_try_steal_tail(gtc, v, level);
+            else
+              steal_size = gtc_steal_tail(gtc, v, level);
+
+            // Steal succeeded: Got some work from remote node
+            if (steal_size > 0) {
+              tc->ct.tasks_stolen += steal_size;
+              tc->ct.num_steals += 1;
+              steal_done = 1;
+              tc->last_target = v;
+              vs_state.target_retry = 0;
+              vs_state.num_retries  = 0;
+              idle.nfails = idle.npause = 0;
+
+            // Steal failed: Got the lock, no longer any work on remote node
+            } else if (steal_size == 0) {
+              tc->ct.failed_steals_locked++;
+              steal_done = 1;
+              vs_state.target_retry = 0;
+              vs_state.num_retries  = 0;
+
+            // Steal aborted: Didn't get the lock, refresh target metadata and try again.  If we
+            // run out of attempts, gtc_select_target() comes back to this target up to
+            // max_steal_retries times before moving on.
+            } else {
               tc->ct.aborted_steals++;
-            vs_state.target_retry = 1;
+              vs_state.target_retry = 1;
+              meta = sdc_shrb_probe(tc->prio_rb[level], v);
+              avail = sdc_meta_shared_size(meta);
+              gtc_victim_observe(tc, v, avail);
+            }
+
+          } else /* ! (avail > 0) */ {
+            tc->ct.failed_steals_unlocked++;
+            steal_done = 1;
+            vs_state.target_retry = 0;
+            vs_state.num_retries  = 0;
           }
 
-        } else /* ! (QUEUE_WORK_AVAIL(target_rb) > 0) */ {
-          tc->ct.failed_steals_unlocked++;
-          steal_done = 1;
-        }
-
-        // Invoke the progress engine
-        gtc_progress(gtc);
-
-        // Still no work? Lock to be sure and check for termination.
-        // Locking is only needed here if we allow pushing.
-        // TODO: New TD should not require locking.  Remove locks and test.
-        if (gtc_tasks_avail(gtc) == 0 && !tc->external_work_avail) {
-          //QUEUE_LOCK(tc->shared_rb, _c->rank);
-          //shrb_lock(tc->inbox, _c->rank); /* no task pushing */
+          // Invoke the progress engine
+          gtc_progress(gtc);
 
+          // Still no work? Lock to be sure and check for termination.
+          // Locking is only needed here if we allow pushing.
+          // TODO: New TD should not require locking.  Remove locks and test.
           if (gtc_tasks_avail(gtc) == 0 && !tc->external_work_avail) {
-            td_set_counters(tc->td, tc->ct.tasks_spawned, tc->ct.tasks_completed);
-            tc->terminated = td_attempt_vote(tc->td);
-          }
+            //QUEUE_LOCK(tc->shared_rb, _c->rank);
+            //shrb_lock(tc->inbox, _c->rank); /* no task pushing */
 
-          //shrb_unlock(tc->inbox, _c->rank); /* no task pushing */
-          //QUEUE_UNLOCK(tc->shared_rb, _c->rank);
+            if (gtc_tasks_avail(gtc) == 0 && !tc->external_work_avail) {
+              td_set_counters(tc->td, tc->ct.tasks_spawned, tc->ct.tasks_completed);
+              tc->terminated = td_attempt_vote(tc->td);
+            }
 
-        // We have work, done stealing
-        } else {
-          steal_done = 1;
+            //shrb_unlock(tc->inbox, _c->rank); /* no task pushing */
+            //QUEUE_UNLOCK(tc->shared_rb, _c->rank);
+
+          // We have work, done stealing
+          } else {
+            steal_done = 1;
+          }
         }
+
       }
 
       if (gtc_tasks_avail(gtc))
         got_task = gtc_get_local_buf(gtc, priority, buf);
+      else if (!tc->terminated)
+        gtc_idle_wait(gtc, &idle);
     }
 
   } else {
@@ -363,18 +436,13 @@ int gtc_add_sdc(gtc_t gtc, task_t *task, int proc) {
   task->created_by = _c->rank;
 
   if (proc == _c->rank) {
-    // Local add: put it straight onto the local work list
-    sdc_shrb_push_head(tc->shared_rb, _c->rank, task, sizeof(task_t) + gtc_task_body_size(task));
+    // Local add: put it straight onto the local work list for its priority level
+    sdc_shrb_push_head(tc->prio_rb[gtc_task_level(tc, task)], _c->rank, task, sizeof(task_t) + gtc_task_body_size(task));
   }
-#if 0 /* no task pushing */
   else {
-    // Remote adds: put this in the remote node's inbox
-    if (task->affinity == 0)
-      shrb_push_head(tc->inbox, proc, task, sizeof(task_t) + gtc_task_body_size(task));
-    else
-      shrb_push_tail(tc->inbox, proc, task, sizeof(task_t) + gtc_task_body_size(task));
+    // Remote adds: batch it up for the remote process's inbox
+    gtc_inbox_push(tc->inbox, proc, task, sizeof(task_t) + gtc_task_body_size(task));
   }
-#endif /* no task pushing */
 
   ++tc->ct.tasks_spawned;
   TC_STOP_TIMER(tc,add);
@@ -389,6 +457,7 @@ int gtc_add_sdc(gtc_t gtc, task_t *task, int proc) {
  * have finished.  The pointer returned points directly to an element in the
  * queue.  Do not add it, do not free it, discard the pointer when you are finished
  * assigning the task body.
+ * In-place tasks are always queued at priority level 0.
  *
  * @param gtc    Portable reference to the task collection
  * @param tclass Desired task class
@@ -407,6 +476,7 @@ task_t *gtc_task_inplace_create_and_add_sdc(gtc_t gtc, task_class_t tclass) {
   t->created_by = _c->rank;
   //t->affinity   = 0;
   t->priority   = 0;
+  t->cost       = 0;
 
   ++tc->ct.tasks_spawned;
 
@@ -438,6 +508,36 @@ void gtc_task_inplace_create_and_add_finish_sdc(gtc_t gtc, task_t *t) {
 }
 
 
+/*
+ * Sum the queue counters over every priority level, the spill high water mark is the largest
+ * of any level.
+ */
+static void gtc_sdc_queue_stats(tc_t *tc, sdc_shrb_stats_t *stats, int *spill_hwm) {
+  memset(stats, 0, sizeof(*stats));
+  *spill_hwm = 0;
+
+  for (int l = 0; l < tc->npriorities; l++) {
+    sdc_shrb_t *rb = tc->prio_rb[l];
+
+    stats->nwaited      += rb->stats->nwaited;
+    stats->nreclaimed   += rb->stats->nreclaimed;
+    stats->nreccalls    += rb->stats->nreccalls;
+    stats->nrelease     += rb->stats->nrelease;
+    stats->nprogress    += rb->stats->nprogress;
+    stats->nreacquire   += rb->stats->nreacquire;
+    stats->ngets        += rb->stats->ngets;
+    stats->nensure      += rb->stats->nensure;
+    stats->nxfer        += rb->stats->nxfer;
+    stats->nsteals      += rb->stats->nsteals;
+    stats->nmeta        += rb->stats->nmeta;
+    stats->nspilled     += rb->stats->nspilled;
+    stats->nlocalsteals += rb->stats->nlocalsteals;
+    if (rb->spill_hwm > *spill_hwm)
+      *spill_hwm = rb->spill_hwm;
+  }
+}
+
+
 /**
  * Print stats for this task collection.
  * @param tc       IN Ptr to task collection
@@ -445,32 +545,38 @@ void gtc_task_inplace_create_and_add_finish_sdc(gtc_t gtc, task_t *t) {
 void gtc_print_stats_sdc(gtc_t gtc) {
   GTC_ENTRY();
   tc_t *tc = gtc_lookup(gtc);
-  sdc_shrb_t *rb = (sdc_shrb_t *)tc->shared_rb;
+  sdc_shrb_stats_t stats;
+  int spill_hwm;
 
   uint64_t perget, peradd, perinplace, perfinish, perprogress, perreclaim, perensure, perrelease, perreacquire, perpoptail;
 
   if (!getenv("SCIOTO_DISABLE_STATS") && !getenv("SCIOTO_DISABLE_PERNODE_STATS")) {
+    gtc_sdc_queue_stats(tc, &stats, &spill_hwm);
+
     // avoid floating point exceptions...
     perget       = tc->ct.getcalls      != 0 ? TC_READ_TIMER(tc,getbuf)    / tc->ct.getcalls      : 0;
     peradd       = tc->ct.tasks_spawned != 0 ? TC_READ_TIMER(tc,add)       / tc->ct.tasks_spawned : 0;
     perinplace   = tc->ct.tasks_spawned != 0 ? TC_READ_TIMER(tc,addinplace)/ tc->ct.tasks_spawned : 0; // borrowed
-    perfinish    = rb->nprogress        != 0 ? TC_READ_TIMER(tc,addfinish) / rb->nprogress     : 0; // borrowed, but why?
-    perprogress  = rb->nprogress        != 0 ? TC_READ_TIMER(tc,progress)  / rb->nprogress     : 0;
-    perreclaim   = rb->nreccalls        != 0 ? TC_READ_TIMER(tc,reclaim)   / rb->nreccalls     : 0;
-    perensure    = rb->nensure          != 0 ? TC_READ_TIMER(tc,ensure)    / rb->nensure       : 0;
-    perrelease   = rb->nrelease         != 0 ? TC_READ_TIMER(tc,release)   / rb->nrelease      : 0;
-    perreacquire = rb->nreacquire       != 0 ? TC_READ_TIMER(tc,reacquire) / rb->nreacquire    : 0;
-    perpoptail   = rb->ngets            != 0 ? TC_READ_TIMER(tc,poptail)   / rb->ngets         : 0;
+    perfinish    = stats.nprogress        != 0 ? TC_READ_TIMER(tc,addfinish) / stats.nprogress     : 0; // borrowed, but why?
+    perprogress  = stats.nprogress        != 0 ? TC_READ_TIMER(tc,progress)  / stats.nprogress     : 0;
+    perreclaim   = stats.nreccalls        != 0 ? TC_READ_TIMER(tc,reclaim)   / stats.nreccalls     : 0;
+    perensure    = stats.nensure          != 0 ? TC_READ_TIMER(tc,ensure)    / stats.nensure       : 0;
+    perrelease   = stats.nrelease         != 0 ? TC_READ_TIMER(tc,release)   / stats.nrelease      : 0;
+    perreacquire = stats.nreacquire       != 0 ? TC_READ_TIMER(tc,reacquire) / stats.nreacquire    : 0;
+    perpoptail   = stats.ngets            != 0 ? TC_READ_TIMER(tc,poptail)   / stats.ngets         : 0;
 
     printf(" %4d - SDC-Q: nrelease %6lu, nreacquire %6lu, nreclaimed %6lu, nwaited %2lu, nprogress %6lu\n"
            " %4d -    failed w/lock: %6lu, failed w/o lock: %6lu, aborted steals: %6lu\n"
-           " %4d -    ngets: %6lu  (%5.2f usec/get) nxfer: %6lu\n",
+           " %4d -    ngets: %6lu  (%5.2f usec/get) nxfer: %6lu\n"
+           " %4d -    spilled: %6lu  spill hwm: %6d\n",
       _c->rank,
-        rb->nrelease, rb->nreacquire, rb->nreclaimed, rb->nwaited, rb->nprogress,
+        stats.nrelease, stats.nreacquire, stats.nreclaimed, stats.nwaited, stats.nprogress,
       _c->rank,
         tc->ct.failed_steals_locked, tc->ct.failed_steals_unlocked, tc->ct.aborted_steals,
       _c->rank,
-        rb->ngets, TC_READ_TIMER_USEC(tc, t[0])/(double)rb->ngets, rb->nxfer);
+        stats.ngets, TC_READ_TIMER_USEC(tc, t[0])/(double)stats.ngets, stats.nxfer,
+      _c->rank,
+        stats.nspilled, spill_hwm);
     printf(" %4d - TSC: get: %"PRIu64"M (%"PRIu64" x %"PRIu64")  add: %"PRIu64"M (%"PRIu64" x %"PRIu64") inplace: %"PRIu64"M (%"PRIu64")\n",
         _c->rank,
         TC_READ_TIMER_M(tc,getbuf), perget, tc->ct.getcalls,
@@ -479,18 +585,18 @@ void gtc_print_stats_sdc(gtc_t gtc) {
     printf(" %4d - TSC: addfinish: %"PRIu64"M (%"PRIu64") progress: %"PRIu64"M (%"PRIu64" x %"PRIu64") reclaim: %"PRIu64"M (%"PRIu64" x %"PRIu64")\n",
         _c->rank,
         TC_READ_TIMER_M(tc,addfinish), perfinish,
-        TC_READ_TIMER_M(tc,progress), perprogress, rb->nprogress,
-        TC_READ_TIMER_M(tc,reclaim), perreclaim, rb->nreccalls);
+        TC_READ_TIMER_M(tc,progress), perprogress, stats.nprogress,
+        TC_READ_TIMER_M(tc,reclaim), perreclaim, stats.nreccalls);
     printf(" %4d - TSC: ensure: %"PRIu64"M (%"PRIu64" x %"PRIu64") release: %"PRIu64"M (%"PRIu64" x %"PRIu64") "
            "reacquire: %"PRIu64"M (%"PRIu64" x %"PRIu64")\n",
         _c->rank,
-        TC_READ_TIMER_M(tc,ensure), perensure, rb->nensure,
-        TC_READ_TIMER_M(tc,release), perrelease, rb->nrelease,
-        TC_READ_TIMER_M(tc,reacquire), perreacquire, rb->nreacquire);
+        TC_READ_TIMER_M(tc,ensure), perensure, stats.nensure,
+        TC_READ_TIMER_M(tc,release), perrelease, stats.nrelease,
+        TC_READ_TIMER_M(tc,reacquire), perreacquire, stats.nreacquire);
     printf(" %4d - TSC: pushhead: %"PRIu64"M (%"PRIu64") poptail: %"PRIu64"M (%"PRIu64" x %"PRIu64")\n",
         _c->rank,
         TC_READ_TIMER_M(tc,pushhead), (uint64_t)0,
-        TC_READ_TIMER_M(tc,poptail), perpoptail, rb->ngets);
+        TC_READ_TIMER_M(tc,poptail), perpoptail, stats.ngets);
   }
   GTC_EXIT();
 }
@@ -504,9 +610,11 @@ void gtc_print_stats_sdc(gtc_t gtc) {
 void gtc_print_gstats_sdc(gtc_t gtc) {
   GTC_ENTRY();
   tc_t *tc = gtc_lookup(gtc);
-  sdc_shrb_t *rb = (sdc_shrb_t *)tc->shared_rb;
+  sdc_shrb_stats_t stats;
+  int spill_hwm;
   double   *times, *mintimes, *maxtimes, *sumtimes;
   uint64_t *counts, *mincounts, *maxcounts, *sumcounts;
+  uint64_t  attempts;
 
   int ntimes = 14;
   times     = gtc_shmem_calloc(ntimes, sizeof(double));
@@ -514,12 +622,14 @@ void gtc_print_gstats_sdc(gtc_t gtc) {
   maxtimes  = gtc_shmem_calloc(ntimes, sizeof(double));
   sumtimes  = gtc_shmem_calloc(ntimes, sizeof(double));
 
-  int ncounts = 13;
+  int ncounts = 17;
   counts     = gtc_shmem_calloc(ncounts, sizeof(uint64_t));
   mincounts  = gtc_shmem_calloc(ncounts, sizeof(uint64_t));
   maxcounts  = gtc_shmem_calloc(ncounts, sizeof(uint64_t));
   sumcounts  = gtc_shmem_calloc(ncounts, sizeof(uint64_t));
 
+  gtc_sdc_queue_stats(tc, &stats, &spill_hwm);
+
 
   times[SDCPopTailTime]        = TC_READ_TIMER_MSEC(tc,poptail);
   times[SDCGetMetaTime]        = TC_READ_TIMER_MSEC(tc,getmeta);
@@ -528,27 +638,31 @@ void gtc_print_gstats_sdc(gtc_t gtc) {
   times[SDCEnsureTime]         = TC_READ_TIMER_USEC(tc,ensure);
   times[SDCReacquireTime]      = TC_READ_TIMER_MSEC(tc,reacquire);
   times[SDCReleaseTime]        = TC_READ_TIMER_USEC(tc,release);
-  times[SDCPerPopTailTime]     = rb->ngets         != 0 ? TC_READ_TIMER_MSEC(tc,poptail)   / rb->ngets         : 0.0;
-  times[SDCPerGetMetaTime]     = rb->nmeta         != 0 ? TC_READ_TIMER_MSEC(tc,getmeta)   / rb->nmeta         : 0.0;
-  times[SDCPerProgressTime]    = rb->nprogress     != 0 ? TC_READ_TIMER_USEC(tc,progress)  / rb->nprogress     : 0.0;
-  times[SDCPerReclaimTime]     = rb->nreccalls     != 0 ? TC_READ_TIMER_USEC(tc,reclaim)   / rb->nreccalls     : 0.0;
-  times[SDCPerEnsureTime]      = rb->nensure       != 0 ? TC_READ_TIMER_USEC(tc,ensure)    / rb->nensure       : 0.0;
-  times[SDCPerReacquireTime]   = rb->nreacquire    != 0 ? TC_READ_TIMER_MSEC(tc,reacquire) / rb->nreacquire    : 0.0;
-  times[SDCPerReleaseTime]     = rb->nrelease      != 0 ? TC_READ_TIMER_USEC(tc,release)   / rb->nrelease      : 0.0;
-
-  counts[SDCNumGets]            = rb->ngets;
+  times[SDCPerPopTailTime]     = stats.ngets         != 0 ? TC_READ_TIMER_MSEC(tc,poptail)   / stats.ngets         : 0.0;
+  times[SDCPerGetMetaTime]     = stats.nmeta         != 0 ? TC_READ_TIMER_MSEC(tc,getmeta)   / stats.nmeta         : 0.0;
+  times[SDCPerProgressTime]    = stats.nprogress     != 0 ? TC_READ_TIMER_USEC(tc,progress)  / stats.nprogress     : 0.0;
+  times[SDCPerReclaimTime]     = stats.nreccalls     != 0 ? TC_READ_TIMER_USEC(tc,reclaim)   / stats.nreccalls     : 0.0;
+  times[SDCPerEnsureTime]      = stats.nensure       != 0 ? TC_READ_TIMER_USEC(tc,ensure)    / stats.nensure       : 0.0;
+  times[SDCPerReacquireTime]   = stats.nreacquire    != 0 ? TC_READ_TIMER_MSEC(tc,reacquire) / stats.nreacquire    : 0.0;
+  times[SDCPerReleaseTime]     = stats.nrelease      != 0 ? TC_READ_TIMER_USEC(tc,release)   / stats.nrelease      : 0.0;
+
+  counts[SDCNumGets]            = stats.ngets;
   counts[SDCGetCalls]           = tc->ct.getcalls;
-  counts[SDCNumMeta]            = rb->nmeta;
+  counts[SDCNumMeta]            = stats.nmeta;
   counts[SDCGetLocalCalls]      = tc->ct.getlocal;
-  counts[SDCNumSteals]          = rb->nsteals;
+  counts[SDCNumSteals]          = tc->ct.num_steals;
   counts[SDCStealFailsLocked]   = tc->ct.failed_steals_locked;
   counts[SDCStealFailsUnlocked] = tc->ct.failed_steals_unlocked;
   counts[SDCAbortedSteals]      = tc->ct.aborted_steals;
-  counts[SDCProgressCalls]      = rb->nprogress;
-  counts[SDCReclaimCalls]       = rb->nreccalls;
-  counts[SDCEnsureCalls]        = rb->nensure;
-  counts[SDCReacquireCalls]     = rb->nreacquire;
-  counts[SDCReleaseCalls]       = rb->nrelease;
+  counts[SDCAbortedTargets]     = tc->ct.aborted_targets;
+  counts[SDCProgressCalls]      = stats.nprogress;
+  counts[SDCReclaimCalls]       = stats.nreccalls;
+  counts[SDCEnsureCalls]        = stats.nensure;
+  counts[SDCReacquireCalls]     = stats.nreacquire;
+  counts[SDCReleaseCalls]       = stats.nrelease;
+  counts[SDCSpilled]            = stats.nspilled;
+  counts[SDCSpillHWM]           = spill_hwm;
+  counts[SDCLocalSteals]        = stats.nlocalsteals;
 
   shmem_min_reduce(SHMEM_TEAM_WORLD, mintimes, times, ntimes);
   shmem_max_reduce(SHMEM_TEAM_WORLD, maxtimes, times, ntimes);
@@ -580,15 +694,24 @@ void gtc_print_gstats_sdc(gtc_t gtc) {
   eprintf("        :   steals     %6lu (%6.2f/%3lu/%3lu)\n",
       sumcounts[SDCNumSteals], sumcounts[SDCNumSteals]/(double)_c->size,
       mincounts[SDCNumSteals], maxcounts[SDCNumSteals]);
+  eprintf("        :   on-node    %6lu (%6.2f/%3lu/%3lu) off-node %6lu\n",
+      sumcounts[SDCLocalSteals], sumcounts[SDCLocalSteals]/(double)_c->size,
+      mincounts[SDCLocalSteals], maxcounts[SDCLocalSteals],
+      sumcounts[SDCNumSteals] - sumcounts[SDCLocalSteals]);
   eprintf("        :   fails lock %6lu (%6.2f/%3lu/%3lu)\n",
       sumcounts[SDCStealFailsLocked], sumcounts[SDCStealFailsLocked]/(double)_c->size,
       mincounts[SDCStealFailsLocked], maxcounts[SDCStealFailsLocked]);
   eprintf("        :   fails un   %6lu (%6.2f/%3lu/%3lu)\n",
       sumcounts[SDCStealFailsUnlocked], sumcounts[SDCStealFailsUnlocked]/(double)_c->size,
       mincounts[SDCStealFailsUnlocked], maxcounts[SDCStealFailsUnlocked]);
-  eprintf("        :   fails ab   %6lu (%6.2f/%3lu/%3lu)\n",
+  attempts = sumcounts[SDCNumSteals] + sumcounts[SDCStealFailsLocked] + sumcounts[SDCAbortedSteals];
+  eprintf("        :   fails ab   %6lu (%6.2f/%3lu/%3lu) %5.1f%% of steal attempts\n",
       sumcounts[SDCAbortedSteals], sumcounts[SDCAbortedSteals]/(double)_c->size,
-      mincounts[SDCAbortedSteals], maxcounts[SDCAbortedSteals]);
+      mincounts[SDCAbortedSteals], maxcounts[SDCAbortedSteals],
+      attempts ? 100.0*sumcounts[SDCAbortedSteals]/attempts : 0.0);
+  eprintf("        :   abandoned  %6lu (%6.2f/%3lu/%3lu) targets given up after max retries\n",
+      sumcounts[SDCAbortedTargets], sumcounts[SDCAbortedTargets]/(double)_c->size,
+      mincounts[SDCAbortedTargets], maxcounts[SDCAbortedTargets]);
 
   eprintf("        : progress   %6.2f/%3lu/%3lu time %6.2fus/%6.2fus/%6.2fus per %6.2fus/%6.2fus/%6.2fus\n",
       sumcounts[SDCProgressCalls]/(double)_c->size, mincounts[SDCProgressCalls], maxcounts[SDCProgressCalls],
@@ -611,6 +734,11 @@ void gtc_print_gstats_sdc(gtc_t gtc) {
       sumtimes[SDCReleaseTime]/_c->size, mintimes[SDCReleaseTime], maxtimes[SDCReleaseTime],
       sumtimes[SDCPerReleaseTime]/_c->size, mintimes[SDCPerReleaseTime], maxtimes[SDCPerReleaseTime]);
 
+  eprintf("        : spilled    %6lu (%6.2f/%3lu/%3lu) high-water %6lu/%3lu\n",
+      sumcounts[SDCSpilled], sumcounts[SDCSpilled]/(double)_c->size,
+      mincounts[SDCSpilled], maxcounts[SDCSpilled],
+      mincounts[SDCSpillHWM], maxcounts[SDCSpillHWM]);
+
   eprintf("&&&  %6.2f %6.2f ", sumtimes[SDCPopTailTime]/_c->size, sumtimes[SDCReacquireTime]/_c->size);
 
 
@@ -637,15 +765,13 @@ void gtc_queue_reset_sdc(gtc_t gtc) {
   tc_t *tc = gtc_lookup(gtc);
 
   // Clear out the ring buffer
-  sdc_shrb_lock(tc->shared_rb, _c->rank);
-  sdc_shrb_reset(tc->shared_rb);
-  sdc_shrb_unlock(tc->shared_rb, _c->rank);
+  for (int l = 0; l < tc->npriorities; l++) {
+    sdc_shrb_lock(tc->prio_rb[l], _c->rank);
+    sdc_shrb_reset(tc->prio_rb[l]);
+    sdc_shrb_unlock(tc->prio_rb[l], _c->rank);
+  }
 
-#if 0 /* no task pushing */
   // Clear out the inbox
-  shrb_lock(tc->inbox, _c->rank);
-  shrb_reset(tc->inbox);
-  shrb_unlock(tc->inbox, _c->rank);
-#endif /* no task pushing */
+  gtc_inbox_clear(tc->inbox);
   GTC_EXIT();
 }
@@ -10,19 +10,24 @@
 #include <unistd.h>
 #include <string.h>
 #include <math.h>
+#include <sched.h>
+#include <time.h>
 
 #include <tc.h>
+#include "inbox.h"
 
 void gtc_print_my_stats(gtc_t gtc);
 //static int dcomp(const void *a, const void *b);
 
 enum target_types_e { FREE, LOCAL_SEARCH, RETRY };
 
-char *target_methods[2] = { "Random", "Round Robin" };
-char *steal_methods[3]  = { "Half", "Greedy", "Chunk" };
+char *target_methods[TARGET_NPOLICIES] = { "Random", "Round Robin", "Xorshift", "Permutation", "Sticky", "Two Choice" };
+char *steal_methods[STEAL_NMETHODS] = { "Half", "Greedy", "Chunk", "Work" };
+char *idle_modes[IDLE_NMODES] = { "Spin", "Backoff", "Adaptive" };
 
 static int gtc_is_seeded = 0;
 
+
 /**
  * Create a new task collection.  Collective call.
  *
@@ -37,6 +42,7 @@ gtc_t gtc_create(int max_body_size, int chunk_size, int shrb_size, gtc_ldbal_cfg
   gtc_t     gtc;
   tc_t     *tc;
   int       localalloc = 0;
+  char     *envp;
 
   UNUSED(chunk_size);
 
@@ -86,11 +92,15 @@ gtc_t gtc_create(int max_body_size, int chunk_size, int shrb_size, gtc_ldbal_cfg
   TC_INIT_TIMER(tc, ensure);
   TC_INIT_TIMER(tc, release);
   TC_INIT_TIMER(tc, reacquire);
+  TC_INIT_TIMER(tc, reacqwait);
+  TC_INIT_TIMER(tc, reacqdefer);
   TC_INIT_TIMER(tc, pushhead);
   TC_INIT_TIMER(tc, poptail);
   TC_INIT_TIMER(tc, getsteal);
   TC_INIT_TIMER(tc, getfail);
   TC_INIT_TIMER(tc, getmeta);
+  TC_INIT_TIMER(tc, stealdone);
+  TC_INIT_TIMER(tc, backoff);
 
   if (!ldbal_cfg) {
     ldbal_cfg = gtc_malloc(sizeof(gtc_ldbal_cfg_t));
@@ -100,6 +110,7 @@ gtc_t gtc_create(int max_body_size, int chunk_size, int shrb_size, gtc_ldbal_cfg
 
   switch (qtype) {
     case GtcQueueSDC:
+    case GtcQueueSDCLF:
     case GtcQueueSAWS:
       break;
     default:
@@ -112,11 +123,6 @@ gtc_t gtc_create(int max_body_size, int chunk_size, int shrb_size, gtc_ldbal_cfg
   if (max_body_size == AUTO_BODY_SIZE)
     max_body_size = gtc_task_class_largest_body_size();
 
-  if (ldbal_cfg->steal_method == STEAL_CHUNK) {
-    tc->steal_buf = gtc_malloc(ldbal_cfg->chunk_size*(sizeof(task_t)+max_body_size));
-  } else {
-    tc->steal_buf = gtc_malloc((shrb_size/2)*(sizeof(task_t)+max_body_size));
-  }
   tc->qtype = qtype;
 
   tc->clod = clod_create(GTC_MAX_CLOD_CLOS);
@@ -126,10 +132,23 @@ gtc_t gtc_create(int max_body_size, int chunk_size, int shrb_size, gtc_ldbal_cfg
   tc->max_body_size = max_body_size;
   tc->terminated    = 0;
 
+  // each priority level gets its own queue, created by the queue implementation
+  tc->npriorities = 1;
+  if ((envp = getenv("GTC_PRIORITIES")) != NULL)
+    tc->npriorities = atoi(envp);
+  if (tc->npriorities < 1 || tc->npriorities > GTC_MAX_PRIORITIES) {
+    gtc_eprintf(DBGERR, "gtc_create: GTC_PRIORITIES must be between 1 and %d\n", GTC_MAX_PRIORITIES);
+    exit(1);
+  }
+
   gtc_ldbal_cfg_set(gtc, ldbal_cfg);
 
+  gtc_victims_create(tc);
+  gtc_lifelines_create(tc);
+
   switch (tc->qtype) {
     case GtcQueueSDC:
+    case GtcQueueSDCLF:
       gtc_create_sdc(gtc, max_body_size, shrb_size, ldbal_cfg);
       break;
     case GtcQueueSAWS:
@@ -141,6 +160,9 @@ gtc_t gtc_create(int max_body_size, int chunk_size, int shrb_size, gtc_ldbal_cfg
       break;
   }
 
+  // remote adds land here, slots match the queue's so drained tasks go straight in
+  tc->inbox = gtc_inbox_create(tc->max_body_size + sizeof(task_t), GTC_INBOX_SIZE, tc);
+
   if (localalloc)
     free(ldbal_cfg);
 
@@ -157,12 +179,13 @@ void gtc_destroy(gtc_t gtc) {
   GTC_ENTRY();
   tc_t *tc = gtc_lookup(gtc);
 
+  gtc_inbox_destroy(tc->inbox);
   tc->cb.destroy(gtc);
 
   td_destroy(tc->td);
   clod_destroy(tc->clod);
-  if (tc->steal_buf)
-    free(tc->steal_buf);
+  gtc_victims_destroy(tc);
+  gtc_lifelines_destroy(tc);
   if (tc->timers)
     free(tc->timers);
 
@@ -195,6 +218,8 @@ void gtc_reset(gtc_t gtc) {
   tc->ct.tasks_spawned   = 0;
   tc->ct.tasks_stolen    = 0;
   tc->ct.num_steals      = 0;
+  tc->ct.tasks_stolen_local = 0;
+  tc->ct.num_steals_local   = 0;
   tc->ct.passive_count   = 0;
   tc->ct.failed_steals_locked   = 0;
   tc->ct.failed_steals_unlocked = 0;
@@ -202,9 +227,20 @@ void gtc_reset(gtc_t gtc) {
   tc->ct.aborted_targets        = 0;
   tc->ct.dispersion_attempts_unlocked = 0;
   tc->ct.dispersion_attempts_locked   = 0;
+  tc->ct.idle_yields = 0;
+  tc->ct.idle_sleeps = 0;
+  tc->ct.lifeline_waits  = 0;
+  tc->ct.lifeline_pushes = 0;
+  tc->ct.lifeline_tasks  = 0;
+  tc->ct.probes          = 0;
+  tc->ct.probe_rounds    = 0;
+  memset(tc->ct.prio_tasks, 0, sizeof(tc->ct.prio_tasks));
+  memset(tc->ct.prio_stolen, 0, sizeof(tc->ct.prio_stolen));
 
   // Reset round-robin counter
   tc->last_target = (_c->rank + 1) % _c->size;
+  gtc_victims_reset(tc);
+  gtc_lifelines_reset(tc);
 
   // Zero out the timers
   memset(tc->timers, 0, sizeof(tc_timers_t));
@@ -216,6 +252,7 @@ void gtc_reset(gtc_t gtc) {
 
   td_reset(tc->td);
 
+  gtc_inbox_reset(tc->inbox);
   tc->cb.reset(gtc);
   GTC_EXIT();
 }
@@ -246,7 +283,7 @@ void gtc_print_config(gtc_t gtc) {
 
   idx += snprintf(msg+idx, size-idx, "Queue: %s", gtc_queue_name(gtc));
 
-  idx += snprintf(msg+idx, size-idx, ", Mutexes: %s", "PtlSwap Spinlocks");
+  idx += snprintf(msg+idx, size-idx, ", Mutexes: %s", synch_mutex_name());
 
   if (tc->ldbal_cfg.stealing_enabled) {
     idx += snprintf(msg+idx, size-idx, ", Target selection: %s", target_methods[tc->ldbal_cfg.target_selection]);
@@ -257,15 +294,31 @@ void gtc_print_config(gtc_t gtc) {
       idx += snprintf(msg+idx, size-idx, ", Steal method: %s", steal_methods[tc->ldbal_cfg.steal_method]);
 
     if (tc->ldbal_cfg.local_search_factor > 0)
-      idx += snprintf(msg+idx, size-idx, ", Locality-aware stealing");
+      idx += snprintf(msg+idx, size-idx, ", Locality-aware stealing (%d%%, %d on-node)",
+          tc->ldbal_cfg.local_search_factor, tc->victims[VICTIMS_NODE].n);
 
     if (tc->ldbal_cfg.steals_can_abort)
       idx += snprintf(msg+idx, size-idx, ", Aborting Steals");
 
+    idx += snprintf(msg+idx, size-idx, ", Idle: %s", idle_modes[tc->ldbal_cfg.idle_mode]);
+
+    if (tc->ldbal_cfg.lifeline_after > 0)
+      idx += snprintf(msg+idx, size-idx, ", Lifelines (%d-cube, after %d failed steals)",
+          tc->nlifelines, tc->ldbal_cfg.lifeline_after);
+
+    if (tc->td->mode == TD_EVENT)
+      idx += snprintf(msg+idx, size-idx, ", Event-driven TD");
+
+    if (tc->ldbal_cfg.probe_width > 1)
+      idx += snprintf(msg+idx, size-idx, ", Probe width: %d", tc->ldbal_cfg.probe_width);
+
   } else {
     idx += snprintf(msg+idx, size-idx, ", Stealing disabled");
   }
 
+  if (tc->npriorities > 1)
+    idx += snprintf(msg+idx, size-idx, ", Priority levels: %d", tc->npriorities);
+
   printf("Task collection %d -- %s\n", gtc, msg);
   free(msg);
   GTC_EXIT();
@@ -293,6 +346,68 @@ int gtc_add(gtc_t gtc, task_t *task, int proc) {
 
 
 
+/**
+ * Seed the task collection before processing it.  Collective call.  Every process hands in
+ * its initial tasks (any of them may hand in none) and the tasks are spread over all processes
+ * in equal blocks: the i-th of all T tasks, in rank order, goes to process i*P/T.  Remote blocks
+ * go out as batched puts into each process's inbox and every process has its block on its
+ * queue when the call returns, so processing starts without a dispersion phase.
+ *
+ * @param gtc    Portable reference to the task collection
+ * @param tasks  IN Tasks to add, copied in, the caller still owns them
+ * @param ntasks IN Number of tasks, 0 is fine
+ * @return total number of tasks handed in by all processes
+ */
+int gtc_scatter(gtc_t gtc, task_t **tasks, int ntasks) {
+  GTC_ENTRY();
+  tc_t     *tc = gtc_lookup(gtc);
+  uint64_t *counts, *allcounts, *pending, *allpending;
+  uint64_t  first = 0, total = 0;
+
+  counts     = gtc_shmem_calloc(_c->size, sizeof(uint64_t));
+  allcounts  = gtc_shmem_calloc(_c->size, sizeof(uint64_t));
+  pending    = gtc_shmem_calloc(1, sizeof(uint64_t));
+  allpending = gtc_shmem_calloc(1, sizeof(uint64_t));
+
+  // everyone learns how many tasks each process has, our tasks start at first
+  counts[_c->rank] = ntasks;
+  shmem_sum_reduce(SHMEM_TEAM_WORLD, allcounts, counts, _c->size);
+
+  for (int p = 0; p < _c->size; p++) {
+    if (p < _c->rank)
+      first += allcounts[p];
+    total += allcounts[p];
+  }
+
+  for (int i = 0; i < ntasks; i++)
+    gtc_add(gtc, tasks[i], (int)(((first + i) * _c->size) / total));
+
+  // keep sending and draining until no one has batches left, inboxes are drained as we go so
+  // a full one can't hold us up
+  do {
+    gtc_inbox_flush(tc->inbox);
+    gtc_inbox_drain(tc->inbox);
+    *pending = tc->inbox->ndirty;
+    shmem_sum_reduce(SHMEM_TEAM_WORLD, allpending, pending, 1);
+  } while (*allpending > 0);
+
+  // the last runs have landed once everyone is through the barrier
+  shmem_barrier_all();
+  gtc_inbox_drain(tc->inbox);
+  gtc_progress(gtc);
+
+  gtc_lprintf(DBGINIT, "gtc_scatter: %d tasks in, %d on my queue, %lu total\n", ntasks, gtc_tasks_avail(gtc), total);
+
+  shmem_free(counts);
+  shmem_free(allcounts);
+  shmem_free(pending);
+  shmem_free(allpending);
+  shmem_barrier_all();
+  GTC_EXIT((int)total);
+}
+
+
+
 /**
  * Create-and-add a task in-place on the head of the queue.  Note, you should
  * not do *ANY* other queue operations until all outstanding in-place creations
@@ -401,7 +516,8 @@ void gtc_set_external_work_avail(gtc_t gtc, int flag) {
  * Get a task from the head of the local patch of the task collection.  This
  * function DOES NOT invoke load balancing, it only checks the local queue for
  * work.  It returns NULL when no local work is available, so a NULL does NOT
- * imply that global termination has been detected.
+ * imply that global termination has been detected.  Tasks are taken from the
+ * highest non-empty priority level.
  *
  * @param gtc      IN Ptr to task collection
  * @return         Ptr to task (from local queue or stolen). NULL if none
@@ -412,17 +528,24 @@ int gtc_get_local_buf(gtc_t gtc, int priority, task_t *buf) {
   GTC_ENTRY();
   tc_t *tc = gtc_lookup(gtc);
   UNUSED(priority);
-  GTC_EXIT(tc->rcb.pop_head(tc->shared_rb, _c->rank, buf));
+
+  for (int l = tc->npriorities-1; l >= 0; l--) {
+    if (tc->rcb.pop_head(tc->prio_rb[l], _c->rank, buf)) {
+      tc->ct.prio_tasks[l]++;
+      GTC_EXIT(1);
+    }
+  }
+  GTC_EXIT(0);
 }
 
 /**
  * gtc_steal_tail -- Attempt to steal a chunk of tasks from the given target's tail.
  *
  * @param  target        Process ID of target
- * @param  req_stealsize Amount of work to steal.
+ * @param  level         Priority level to steal from
  * @return number of tasks stolen
  */
-int gtc_steal_tail(gtc_t gtc, int target) {
+int gtc_steal_tail(gtc_t gtc, int target, int level) {
   GTC_ENTRY();
   tc_t *tc = gtc_lookup(gtc);
   int   stealsize;
@@ -436,7 +559,7 @@ int gtc_steal_tail(gtc_t gtc, int target) {
 
   TC_INIT_ATIMER(temp);
   TC_START_ATIMER(temp);
-  stealsize = tc->rcb.pop_n_tail(tc->shared_rb, target, req_stealsize, tc->steal_buf, tc->ldbal_cfg.steal_method);
+  stealsize = tc->rcb.steal_n_tail(tc->prio_rb[level], target, req_stealsize, tc->ldbal_cfg.steal_method);
   TC_STOP_ATIMER(temp);
 
   // account into success or failed steal timers
@@ -445,14 +568,21 @@ int gtc_steal_tail(gtc_t gtc, int target) {
   else
     TC_ADD_TIMER(tc, getfail, temp);
 
+  // stolen tasks land directly on the head of our queue at the same level
   if (stealsize > 0) {
+    tc->ct.prio_stolen[level] += stealsize;
+    if (tc->on_node[target]) {
+      tc->ct.tasks_stolen_local += stealsize;
+      tc->ct.num_steals_local++;
+    }
+    gtc_victim_stolen(tc, target, stealsize);
     gtc_lprintf(DBGGET, "\tthread %d: steal try: %d got: %d tasks from thread %d\n", _c->rank, req_stealsize, stealsize, target);
-    tc->rcb.push_n_head(tc->shared_rb, _c->rank, tc->steal_buf, stealsize);
 
   } else if (stealsize < 0) {
     //gtc_lprintf(DBGGET, "\tthread %d: Aborting steal from %d\n", _c->rank, target);
     // XXX should account for number of aborted steals?
   } else {
+    gtc_victim_stolen(tc, target, 0);
     //gtc_lprintf(DBGGET, "\tthread %d: failed steal got no tasks from thread %d\n", _c->rank, target);
   }
 
@@ -464,15 +594,15 @@ int gtc_steal_tail(gtc_t gtc, int target) {
  * gtc_try_steal_tail -- Attempt to steal a chunk of tasks from the given target's tail.
  *
  * @param  target        Process ID of target
- * @param  req_stealsize Amount of work to steal.  If this number is negative, perform work
- *                       splitting and get up to abs(req_stealsize) tasks.
+ * @param  level         Priority level to steal from
  * @return number of tasks stolen or -1 on failure
  */
-int gtc_try_steal_tail(gtc_t gtc, int target) {
+int gtc_try_steal_tail(gtc_t gtc, int target, int level) {
   GTC_ENTRY();
   tc_t *tc = gtc_lookup(gtc);
   int   stealsize;
   int   req_stealsize;
+  tc_timer_t temp;
 
   if (tc->ldbal_cfg.steal_method == STEAL_CHUNK)
     req_stealsize = tc->ldbal_cfg.chunk_size;
@@ -481,23 +611,29 @@ int gtc_try_steal_tail(gtc_t gtc, int target) {
 
   gtc_lprintf(DBGGET, "attempting to steal from %d\n", target);
 
-#ifdef QUEUE_TRY_POP_N_TAIL
-  if (tc->qtype == GtcQueueSAWS)
-    stealsize = tc->cb.try_pop_n_tail(tc->shrb, target, req_stealsize, tc->steal_buf, tc->ldbal_cfg.      steal_method);
-  else
-    stealsize = tc->cb.try_pop_n_tail(tc->shared_rb, target, req_stealsize, tc->steal_buf, tc->ldbal_cfg.         steal_method);
-
-
-#else
-  stealsize = tc->rcb.pop_n_tail(tc->shared_rb, target, req_stealsize, tc->steal_buf, tc->ldbal_cfg.         steal_method);
-#endif
+  TC_INIT_ATIMER(temp);
+  TC_START_ATIMER(temp);
+  stealsize = tc->rcb.try_steal_n_tail(tc->prio_rb[level], target, req_stealsize, tc->ldbal_cfg.steal_method);
+  TC_STOP_ATIMER(temp);
 
+  // account into success or failed steal timers, aborts count as failures
+  if (stealsize > 0)
+    TC_ADD_TIMER(tc, getsteal, temp);
+  else
+    TC_ADD_TIMER(tc, getfail, temp);
 
   if (stealsize > 0) {
+    tc->ct.prio_stolen[level] += stealsize;
+    if (tc->on_node[target]) {
+      tc->ct.tasks_stolen_local += stealsize;
+      tc->ct.num_steals_local++;
+    }
+    gtc_victim_stolen(tc, target, stealsize);
     gtc_lprintf(DBGGET, "stole %d tasks from %d\n", stealsize, target);
-    tc->rcb.push_n_head(tc->shared_rb, _c->rank, tc->steal_buf, stealsize);
   } else if (stealsize < 0) {
     gtc_lprintf(DBGGET, "aborting steal from %d\n", target);
+  } else {
+    gtc_victim_stolen(tc, target, 0);
   }
 
   //gtc_lprintf(DBGGET, "steal completed\n");
@@ -531,7 +667,9 @@ int gtc_select_target(gtc_t gtc, gtc_vs_state_t *state) {
   if (state->target_retry) {
     // Note: max_steal_retries < 0 means infinite number of retries
     if (state->num_retries >= tc->ldbal_cfg.max_steal_retries && tc->ldbal_cfg.max_steal_retries > 0) {
-      state->num_retries = 0;
+      // Give up on this target and move on
+      state->target_retry = 0;
+      state->num_retries  = 0;
       tc->ct.aborted_targets++;
 
     } else {
@@ -541,25 +679,21 @@ int gtc_select_target(gtc_t gtc, gtc_vs_state_t *state) {
     }
   }
 
-  /* FREE: Free target selection.
-  */
+  /* FREE: Free target selection.  When we have victims both on and off our node,
+   * choose from the on-node ones local_search_factor percent of the time and from
+   * the off-node ones otherwise.  The selection policy picks a victim from that set.
+   */
   if (v < 0) {
-    // Target Random: Randomly select the next target
-    if (tc->ldbal_cfg.target_selection == TARGET_RANDOM) {
-      do {
-        v = rand() % _c->size;
-      } while (v == _c->rank);
-    }
+    gtc_victim_set_t *set = &tc->victims[VICTIMS_ALL];
 
-    // Round Robin: Next target is selected round-robin
-    else if (tc->ldbal_cfg.target_selection == TARGET_ROUND_ROBIN) {
-      v = (state->last_target + 1) % _c->size;
+    if (tc->victims[VICTIMS_NODE].n > 0 && tc->victims[VICTIMS_REMOTE].n > 0) {
+      if (gtc_victim_coin(tc, tc->ldbal_cfg.local_search_factor))
+        set = &tc->victims[VICTIMS_NODE];
+      else
+        set = &tc->victims[VICTIMS_REMOTE];
     }
 
-    else {
-      printf("Unknown target selection method\n");
-      assert(0);
-    }
+    v = tc->select_victim(tc, set);
   }
 
   state->last_target = v;
@@ -569,6 +703,46 @@ int gtc_select_target(gtc_t gtc, gtc_vs_state_t *state) {
 
 
 
+/** Back off after a failed steal.  Spinning goes straight back to stealing, backoff pauses for
+ *  twice as long after each consecutive failure, and adaptive moves on to yielding the CPU and
+ *  then sleeping once the failures pile up.  Zero the idle state when work is found.
+ *
+ * @param[in] gtc   Current task collection
+ * @param[in] idle  Idle state for this search
+ */
+void gtc_idle_wait(gtc_t gtc, gtc_idle_state_t *idle) {
+  GTC_ENTRY();
+  tc_t *tc = gtc_lookup(gtc);
+  gtc_ldbal_cfg_t *cfg = &tc->ldbal_cfg;
+
+  idle->nfails++;
+
+  if (cfg->idle_mode == IDLE_SPIN)
+    GTC_EXIT();
+
+  TC_START_TIMER(tc, backoff);
+  if (cfg->idle_mode == IDLE_ADAPTIVE && cfg->idle_sleep_after > 0 && idle->nfails >= cfg->idle_sleep_after) {
+    struct timespec sleep = { 0, cfg->idle_sleep_ns };
+    nanosleep(&sleep, NULL);
+    tc->ct.idle_sleeps++;
+
+  } else if (cfg->idle_mode == IDLE_ADAPTIVE && cfg->idle_yield_after > 0 && idle->nfails >= cfg->idle_yield_after) {
+    sched_yield();
+    tc->ct.idle_yields++;
+
+  } else {
+    for (int i = 0; i < idle->npause; i++)
+      _mm_pause();
+    idle->npause = idle->npause ? 2*idle->npause : 1;
+    if (idle->npause > cfg->idle_pause_max)
+      idle->npause = cfg->idle_pause_max;
+  }
+  TC_STOP_TIMER(tc, backoff);
+  GTC_EXIT();
+}
+
+
+
 /**
  * Processes the task collection. Collective call. Handles load-balancing
  * and stealing if it is enabled. Returns collectively.
@@ -634,7 +808,10 @@ typedef enum {
   SearchTime,
   AcquireTime,
   DispersionTime,
-  ImbalanceTime
+  ImbalanceTime,
+  MutexAttemptsSqTime,  // not a time, sum of squared lock attempts (for the variance)
+  BackoffTime,
+  SearchPerStealTime
 } gtc_gtimestats_e;
 
 
@@ -642,10 +819,198 @@ typedef enum {
   TasksCompleted,
   TasksStolen,
   NumSteals,
-  DispersionAttempts
+  TasksStolenLocal,
+  NumStealsLocal,
+  FailedSteals,
+  IdleYields,
+  IdleSleeps,
+  LifelineWaits,
+  LifelinePushes,
+  LifelineTasks,
+  TDWaits,
+  Probes,
+  ProbeRounds,
+  DispersionAttempts,
+  MutexLockCalls,
+  MutexLockContended,
+  MutexLockAttempts,
+  MutexLockMaxAttempts,
+  InboxSent,
+  InboxBatches,
+  InboxRecvd,
+  InboxFull,
+  PrioTasks,                                  // GTC_MAX_PRIORITIES entries, tasks taken at each level
+  PrioStolen = PrioTasks + GTC_MAX_PRIORITIES // GTC_MAX_PRIORITIES entries, tasks stolen at each level
 } gtc_gcountstats_e;
 
 
+/*
+ * Print the split between steals from on-node and off-node victims.
+ */
+static void gtc_print_locality_gstats(tc_t *tc, uint64_t *sumcounts) {
+  eprintf("        : victims    on-node %6lu steals (%6lu tasks) off-node %6lu steals (%6lu tasks) local search %d%%\n",
+      sumcounts[NumStealsLocal], sumcounts[TasksStolenLocal],
+      sumcounts[NumSteals] - sumcounts[NumStealsLocal], sumcounts[TasksStolen] - sumcounts[TasksStolenLocal],
+      tc->ldbal_cfg.local_search_factor);
+}
+
+
+/*
+ * Fill in the idle counters, failed steals include aborted ones.
+ */
+static void gtc_idle_stats(tc_t *tc, double *times, uint64_t *counts) {
+  times[BackoffTime]   = TC_READ_TIMER_MSEC(tc, backoff);
+  counts[FailedSteals] = tc->ct.failed_steals_locked + tc->ct.failed_steals_unlocked + tc->ct.aborted_steals;
+  counts[IdleYields]   = tc->ct.idle_yields;
+  counts[IdleSleeps]   = tc->ct.idle_sleeps;
+}
+
+
+/*
+ * Print the idle line, failed steals per second of passive time and time spent backing off.
+ */
+static void gtc_print_idle_gstats(tc_t *tc, double *sumtimes, double *maxtimes, uint64_t *sumcounts) {
+  eprintf("        : idle       %-8s failed steals %6lu (%8.0f/s passive) backoff %6.2fms/%6.2fms yields %lu sleeps %lu\n",
+      idle_modes[tc->ldbal_cfg.idle_mode], sumcounts[FailedSteals],
+      sumtimes[PassiveTime] > 0.0 ? sumcounts[FailedSteals]/sumtimes[PassiveTime] : 0.0,
+      sumtimes[BackoffTime]/_c->size, maxtimes[BackoffTime],
+      sumcounts[IdleYields], sumcounts[IdleSleeps]);
+}
+
+
+/*
+ * Fill in the lifeline counters.
+ */
+static void gtc_lifeline_stats(tc_t *tc, uint64_t *counts) {
+  counts[LifelineWaits]  = tc->ct.lifeline_waits;
+  counts[LifelinePushes] = tc->ct.lifeline_pushes;
+  counts[LifelineTasks]  = tc->ct.lifeline_tasks;
+  counts[TDWaits]        = tc->td->num_waits;
+}
+
+
+/*
+ * Print the lifeline line, only when lifelines are enabled.  TD waits are the times a waiting
+ * process blocked in termination detection instead of polling.
+ */
+static void gtc_print_lifeline_gstats(tc_t *tc, uint64_t *sumcounts, uint64_t *maxcounts) {
+  if (tc->ldbal_cfg.lifeline_after == 0)
+    return;
+
+  eprintf("        : lifelines  waits %6lu (max %lu) pushes %6lu tasks %6lu (%6.2f/push) td waits %6lu\n",
+      sumcounts[LifelineWaits], maxcounts[LifelineWaits], sumcounts[LifelinePushes], sumcounts[LifelineTasks],
+      sumcounts[LifelinePushes] ? sumcounts[LifelineTasks]/(double)sumcounts[LifelinePushes] : 0.0,
+      sumcounts[TDWaits]);
+}
+
+
+/*
+ * Fill in search time per successful steal and the multi-victim probe counters.
+ */
+static void gtc_search_stats(tc_t *tc, double *times, uint64_t *counts) {
+  times[SearchPerStealTime] = tc->ct.num_steals ? TC_READ_TIMER_MSEC(tc, search)/tc->ct.num_steals : 0.0;
+  counts[Probes]            = tc->ct.probes;
+  counts[ProbeRounds]       = tc->ct.probe_rounds;
+}
+
+
+/*
+ * Print the search line, probe counts only when probing more than one victim at once.
+ */
+static void gtc_print_search_gstats(tc_t *tc, double *sumtimes, double *maxtimes, uint64_t *sumcounts) {
+  if (tc->ldbal_cfg.probe_width > 1)
+    eprintf("        : search     %6.3fms/%6.3fms per steal probes width %d victims %6lu in %6lu rounds (%5.2f/round)\n",
+        sumtimes[SearchPerStealTime]/_c->size, maxtimes[SearchPerStealTime], tc->ldbal_cfg.probe_width,
+        sumcounts[Probes], sumcounts[ProbeRounds],
+        sumcounts[ProbeRounds] ? sumcounts[Probes]/(double)sumcounts[ProbeRounds] : 0.0);
+  else
+    eprintf("        : search     %6.3fms/%6.3fms per steal\n",
+        sumtimes[SearchPerStealTime]/_c->size, maxtimes[SearchPerStealTime]);
+}
+
+
+/*
+ * Fill in the lock contention counters from mutex.c, these are per process and cover every
+ * mutex it has locked.
+ */
+static void gtc_mutex_stats(double *times, uint64_t *counts) {
+  times[MutexAttemptsSqTime]   = synch_mutex_lock_nattempts_squares;
+  counts[MutexLockCalls]       = synch_mutex_lock_ncalls;
+  counts[MutexLockContended]   = synch_mutex_lock_ncalls_contention;
+  counts[MutexLockAttempts]    = synch_mutex_lock_nattempts_sum;
+  counts[MutexLockMaxAttempts] = synch_mutex_lock_nattempts_max;
+}
+
+
+/*
+ * Print the lock contention line, mean and standard deviation of attempts per acquisition.
+ */
+static void gtc_print_mutex_gstats(double *sumtimes, uint64_t *sumcounts, uint64_t *maxcounts) {
+  double mean = 0.0, var = 0.0;
+
+  if (sumcounts[MutexLockCalls] > 0) {
+    mean = sumcounts[MutexLockAttempts] / (double)sumcounts[MutexLockCalls];
+    var  = sumtimes[MutexAttemptsSqTime] / sumcounts[MutexLockCalls] - mean*mean;
+  }
+
+  eprintf("        : locks      %6lu contended %6lu (%5.1f%%) attempts/lock %6.2f (sd %6.2f, max %lu) [%s]\n",
+      sumcounts[MutexLockCalls], sumcounts[MutexLockContended],
+      sumcounts[MutexLockCalls] ? 100.0*sumcounts[MutexLockContended]/sumcounts[MutexLockCalls] : 0.0,
+      mean, var > 0.0 ? sqrt(var) : 0.0, maxcounts[MutexLockMaxAttempts], synch_mutex_name());
+}
+
+
+
+/*
+ * Fill in the remote add counters from the inbox.
+ */
+static void gtc_inbox_stats(tc_t *tc, uint64_t *counts) {
+  counts[InboxSent]    = tc->inbox->stats.nsent;
+  counts[InboxBatches] = tc->inbox->stats.nbatches;
+  counts[InboxRecvd]   = tc->inbox->stats.nrecvd;
+  counts[InboxFull]    = tc->inbox->stats.nfull;
+}
+
+
+/*
+ * Print the remote add line, only when something was pushed.
+ */
+static void gtc_print_inbox_gstats(uint64_t *sumcounts, uint64_t *maxcounts) {
+  if (sumcounts[InboxSent] == 0)
+    return;
+
+  eprintf("        : pushed     %6lu in %6lu batches (%6.2f/batch) drained %6lu (max %lu) deferred %lu (inbox full)\n",
+      sumcounts[InboxSent], sumcounts[InboxBatches],
+      sumcounts[InboxBatches] ? sumcounts[InboxSent]/(double)sumcounts[InboxBatches] : 0.0,
+      sumcounts[InboxRecvd], maxcounts[InboxRecvd], sumcounts[InboxFull]);
+}
+
+
+
+/*
+ * Fill in the per priority level task counts.
+ */
+static void gtc_prio_stats(tc_t *tc, uint64_t *counts) {
+  for (int l = 0; l < GTC_MAX_PRIORITIES; l++) {
+    counts[PrioTasks+l]  = tc->ct.prio_tasks[l];
+    counts[PrioStolen+l] = tc->ct.prio_stolen[l];
+  }
+}
+
+
+/*
+ * Print a line per priority level, only when more than one is in use.
+ */
+static void gtc_print_prio_gstats(tc_t *tc, uint64_t *sumcounts, uint64_t *maxcounts) {
+  if (tc->npriorities == 1)
+    return;
+
+  for (int l = tc->npriorities-1; l >= 0; l--)
+    eprintf("        : priority %d tasks %6lu (max %lu) stolen %6lu (max %lu)\n", l,
+        sumcounts[PrioTasks+l], maxcounts[PrioTasks+l], sumcounts[PrioStolen+l], maxcounts[PrioStolen+l]);
+}
+
+
 
 /**
  * Print stats for this task collection.
@@ -680,13 +1045,13 @@ void gtc_print_gstats(gtc_t gtc) {
   fflush(NULL);
   shmem_barrier_all();
 
-  int ntimes = 7;
+  int ntimes = SearchPerStealTime + 1;
   times     = gtc_shmem_calloc(ntimes, sizeof(double));
   mintimes  = gtc_shmem_calloc(ntimes, sizeof(double));
   maxtimes  = gtc_shmem_calloc(ntimes, sizeof(double));
   sumtimes  = gtc_shmem_calloc(ntimes, sizeof(double));
 
-  int ncounts = 4;
+  int ncounts = PrioStolen + GTC_MAX_PRIORITIES;
   counts     = gtc_shmem_calloc(ncounts, sizeof(uint64_t));
   mincounts  = gtc_shmem_calloc(ncounts, sizeof(uint64_t));
   maxcounts  = gtc_shmem_calloc(ncounts, sizeof(uint64_t));
@@ -709,6 +1074,14 @@ void gtc_print_gstats(gtc_t gtc) {
   counts[TasksCompleted]     = tc->ct.tasks_completed;
   counts[TasksStolen]        = tc->ct.tasks_stolen;
   counts[NumSteals]          = tc->ct.num_steals;
+  counts[TasksStolenLocal]   = tc->ct.tasks_stolen_local;
+  counts[NumStealsLocal]     = tc->ct.num_steals_local;
+  gtc_mutex_stats(times, counts);
+  gtc_idle_stats(tc, times, counts);
+  gtc_lifeline_stats(tc, counts);
+  gtc_search_stats(tc, times, counts);
+  gtc_inbox_stats(tc, counts);
+  gtc_prio_stats(tc, counts);
 
   shmem_min_reduce(SHMEM_TEAM_WORLD, mintimes, times, ntimes);
   shmem_max_reduce(SHMEM_TEAM_WORLD, maxtimes, times, ntimes);
@@ -731,6 +1104,13 @@ void gtc_print_gstats(gtc_t gtc) {
         sumtimes[AcquireTime]/(_c->size*1000.0),
         sumtimes[SearchTime]/(_c->size),
         sumtimes[SearchTime]/sumtimes[PassiveTime]);
+    gtc_print_locality_gstats(tc, sumcounts);
+    gtc_print_idle_gstats(tc, sumtimes, maxtimes, sumcounts);
+    gtc_print_lifeline_gstats(tc, sumcounts, maxcounts);
+    gtc_print_search_gstats(tc, sumtimes, maxtimes, sumcounts);
+    gtc_print_mutex_gstats(sumtimes, sumcounts, maxcounts);
+    gtc_print_inbox_gstats(sumcounts, maxcounts);
+    gtc_print_prio_gstats(tc, sumcounts, maxcounts);
     tc->cb.print_gstats(gtc);
   }
 
@@ -790,13 +1170,13 @@ void gtc_print_stats(gtc_t gtc) {
   fflush(NULL);
   shmem_barrier_all();
 
-  int ntimes = 7;
+  int ntimes = SearchPerStealTime + 1;
   times     = gtc_shmem_calloc(ntimes, sizeof(double));
   mintimes  = gtc_shmem_calloc(ntimes, sizeof(double));
   maxtimes  = gtc_shmem_calloc(ntimes, sizeof(double));
   sumtimes  = gtc_shmem_calloc(ntimes, sizeof(double));
 
-  int ncounts = 4;
+  int ncounts = PrioStolen + GTC_MAX_PRIORITIES;
   counts     = gtc_shmem_calloc(ncounts, sizeof(uint64_t));
   mincounts  = gtc_shmem_calloc(ncounts, sizeof(uint64_t));
   maxcounts  = gtc_shmem_calloc(ncounts, sizeof(uint64_t));
@@ -819,7 +1199,15 @@ void gtc_print_stats(gtc_t gtc) {
   counts[TasksCompleted]     = tc->ct.tasks_completed;
   counts[TasksStolen]        = tc->ct.tasks_stolen;
   counts[NumSteals]          = tc->ct.num_steals;
+  counts[TasksStolenLocal]   = tc->ct.tasks_stolen_local;
+  counts[NumStealsLocal]     = tc->ct.num_steals_local;
   counts[DispersionAttempts] = tc->ct.dispersion_attempts_locked + tc->ct.dispersion_attempts_unlocked;
+  gtc_mutex_stats(times, counts);
+  gtc_idle_stats(tc, times, counts);
+  gtc_lifeline_stats(tc, counts);
+  gtc_search_stats(tc, times, counts);
+  gtc_inbox_stats(tc, counts);
+  gtc_prio_stats(tc, counts);
 
   shmem_min_reduce(SHMEM_TEAM_WORLD, mintimes, times, ntimes);
   shmem_max_reduce(SHMEM_TEAM_WORLD, maxtimes, times, ntimes);
@@ -842,14 +1230,22 @@ void gtc_print_stats(gtc_t gtc) {
       sumcounts[TasksCompleted]/(sumtimes[ProcessTime]/_c->size),
       sumcounts[TasksCompleted]/sumtimes[ProcessTime]);
 
-  eprintf("        : dispersion %6.2fms/%6.2fms/%6.2fms attempts %6.2f (%6.2f/%6.2f/%6.2f)\n",
+  eprintf("        : dispersion %6.2fms/%6.2fms/%6.2fms attempts %6lu (%6.2f/%3lu/%3lu)\n",
       sumtimes[DispersionTime]/_c->size, mintimes[DispersionTime], maxtimes[DispersionTime],
-      sumcounts[DispersionAttempts], sumcounts[DispersionAttempts]/_c->size,
+      sumcounts[DispersionAttempts], sumcounts[DispersionAttempts]/(double)_c->size,
       mincounts[DispersionAttempts], maxcounts[DispersionAttempts]);
 
   eprintf("        : imbalance  %6.2fms/%6.2fms/%6.2fms  termination attempts: %d\n",
       sumtimes[ImbalanceTime]/_c->size, mintimes[ImbalanceTime], maxtimes[ImbalanceTime], tc->td->num_attempts);
 
+  gtc_print_locality_gstats(tc, sumcounts);
+  gtc_print_idle_gstats(tc, sumtimes, maxtimes, sumcounts);
+  gtc_print_lifeline_gstats(tc, sumcounts, maxcounts);
+  gtc_print_search_gstats(tc, sumtimes, maxtimes, sumcounts);
+  gtc_print_mutex_gstats(sumtimes, sumcounts, maxcounts);
+  gtc_print_inbox_gstats(sumcounts, maxcounts);
+  gtc_print_prio_gstats(tc, sumcounts, maxcounts);
+
   tc->cb.print_gstats(gtc);
 
 
@@ -0,0 +1,387 @@
+/*********************************************************************/
+/*                                                                   */
+/*  inbox.c - scioto remote task inbox (multi-producer ring)         */
+/*    (c) 2021 see COPYRIGHT in top-level                            */
+/*                                                                   */
+/*********************************************************************/
+#include <sys/types.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tc.h"
+#include "inbox.h"
+
+
+/**
+ * Remote Task Inbox Semantics:
+ * ===========================
+ *
+ * gtc_add() to another process lands the task in that process's inbox, the owner moves it onto
+ * the head of its own queue the next time it makes progress.
+ *
+ * Positions grow without bound, slot = position % max_size.
+ *
+ * reserved - next position a producer can claim.  Producers add the size of their batch with
+ *            one remote fetch-add and own the run [old reserved, old reserved + n).
+ * head     - next position the owner will drain.  Producers read it to make sure their run
+ *            doesn't overwrite slots that haven't been drained yet.
+ * ready[s] - set by the producer to the end of its run once the run's tasks have landed, on
+ *            the run's first slot only.  The owner drains [head, ready[head % max_size]) when
+ *            ready[head % max_size] > head and stops at the first run still in flight.
+ *
+ * Remote adds are buffered per destination and sent as one run when the buffer fills or on the
+ * next gtc_progress(), so bursts of adds to the same process cost one atomic and one put.  If
+ * the destination's inbox is full the run stays reserved and buffered and is retried on the
+ * next flush, a producer never waits on a process that may not be draining.
+ *
+ * Termination: the producer counts the task as spawned when it is added, the process that runs
+ * it counts it as completed, so tasks that are buffered or in flight keep the global counts
+ * unbalanced.  gtc_inbox_size() covers reserved-but-not-drained runs and our own unsent
+ * batches so that neither end votes while it is holding pushed work.  Each published run wakes
+ * the destination in case it is blocked in td_wait() (GTC_TD_MODE=event).
+ */
+
+
+/**
+ * Create a new inbox.  Collective call.
+ *
+ * @param elem_size Size of a task slot, must match the queue the inbox drains into.
+ * @param max_size  Number of task slots (GTC_INBOX_SIZE overrides).
+ * @param tc        Task collection whose queue receives drained tasks.
+ * @return          inbox
+ */
+gtc_inbox_t *gtc_inbox_create(int elem_size, int max_size, tc_t *tc) {
+  GTC_ENTRY();
+  gtc_inbox_t *ib;
+  char *envp;
+  int   batch = GTC_INBOX_BATCH;
+
+  if ((envp = getenv("GTC_INBOX_SIZE")) != NULL)
+    max_size = atoi(envp);
+  if ((envp = getenv("GTC_INBOX_BATCH")) != NULL)
+    batch = atoi(envp);
+
+  if (max_size < 1 || batch < 1) {
+    gtc_eprintf(DBGERR, "gtc_inbox_create: inbox size (%d) and batch (%d) must be positive\n", max_size, batch);
+    exit(1);
+  }
+
+  // a run has to fit in the ring
+  if (batch > max_size)
+    batch = max_size;
+
+  ib = gtc_shmem_calloc(1, sizeof(gtc_inbox_t) + GTC_INBOX_ALIGN((int64_t)max_size * elem_size)
+                           + max_size * sizeof(uint64_t));
+  if (!ib) {
+    gtc_eprintf(DBGERR, "gtc_inbox_create: unable to allocate inbox\n");
+    exit(1);
+  }
+
+  ib->procid    = _c->rank;
+  ib->nproc     = _c->size;
+  ib->elem_size = elem_size;
+  ib->max_size  = max_size;
+  ib->batch     = batch;
+  ib->tc        = tc;
+
+  ib->outbox    = gtc_calloc(ib->nproc, sizeof(u_int8_t *));
+  ib->nout      = gtc_calloc(ib->nproc, sizeof(int));
+  ib->ncap      = gtc_calloc(ib->nproc, sizeof(int));
+  ib->rbase     = gtc_calloc(ib->nproc, sizeof(int64_t));
+  ib->rlen      = gtc_calloc(ib->nproc, sizeof(int));
+  ib->dirty     = gtc_calloc(ib->nproc, sizeof(int));
+  ib->nsent     = gtc_calloc(ib->nproc, sizeof(int));
+
+  shmem_barrier_all();
+  GTC_EXIT(ib);
+}
+
+
+
+/**
+ * Free an inbox.  Collective call.
+ */
+void gtc_inbox_destroy(gtc_inbox_t *ib) {
+  GTC_ENTRY();
+  shmem_barrier_all();
+
+  for (int i = 0; i < ib->nproc; i++)
+    if (ib->outbox[i])
+      free(ib->outbox[i]);
+  free(ib->outbox);
+  free(ib->nout);
+  free(ib->ncap);
+  free(ib->rbase);
+  free(ib->rlen);
+  free(ib->dirty);
+  free(ib->nsent);
+  shmem_free(ib);
+  GTC_EXIT();
+}
+
+
+
+/**
+ * Discard anything in the inbox and any unsent batches.  Collective call.
+ */
+void gtc_inbox_reset(gtc_inbox_t *ib) {
+  GTC_ENTRY();
+  shmem_quiet();
+  shmem_barrier_all();
+
+  ib->reserved = 0;
+  ib->head     = 0;
+  memset(gtc_inbox_ready(ib, 0), 0, ib->max_size * sizeof(uint64_t));
+
+  for (int i = 0; i < ib->ndirty; i++)
+    ib->nout[ib->dirty[i]] = 0;
+  ib->ndirty = 0;
+  memset(ib->rlen, 0, ib->nproc * sizeof(int));
+
+  memset(&ib->stats, 0, sizeof(gtc_inbox_stats_t));
+
+  shmem_barrier_all();
+  GTC_EXIT();
+}
+
+
+
+/*
+ * Send the front of proc's batch buffer as one run.  The run is reserved on the first attempt
+ * and written once proc has drained enough of its inbox to hold it.  A full inbox never blocks
+ * us: the reservation is kept and retried on a later flush, since proc may not be draining
+ * (e.g. it is sitting in a barrier while we seed work).  The run's tasks stay in the buffer
+ * until the caller has done a shmem_quiet() and called gtc_inbox_sent().
+ *
+ * @return number of tasks sent, 0 if proc's inbox is still full
+ */
+static int gtc_inbox_send(gtc_inbox_t *ib, int proc) {
+  int64_t base, first;
+  int     n, part;
+
+  if (ib->rlen[proc] == 0) {
+    n = ib->nout[proc] < ib->max_size ? ib->nout[proc] : ib->max_size;
+    ib->rbase[proc] = shmem_atomic_fetch_add(&ib->reserved, (int64_t)n, proc);
+    ib->rlen[proc]  = n;
+  }
+
+  base = ib->rbase[proc];
+  n    = ib->rlen[proc];
+
+  if (base + n - shmem_atomic_fetch(&ib->head, proc) > ib->max_size) {
+    ib->stats.nfull++;
+    return 0;
+  }
+
+  first = base % ib->max_size;
+  part  = n;
+  if (part > ib->max_size - first)
+    part = ib->max_size - first;
+
+  shmem_putmem_nbi(gtc_inbox_slot(ib, first), ib->outbox[proc], (size_t)part * ib->elem_size, proc);
+  if (part < n)
+    shmem_putmem_nbi(gtc_inbox_slot(ib, 0), ib->outbox[proc] + (size_t)part * ib->elem_size,
+        (size_t)(n - part) * ib->elem_size, proc);
+
+  shmem_fence(); // the tasks land before the run is published
+  shmem_atomic_set(gtc_inbox_ready(ib, first), (uint64_t)(base + n), proc);
+
+  // the destination may be blocked in termination detection with a full inbox
+  td_wake(ib->tc->td, proc);
+
+  gtc_lprintf(DBGINBOX, "gtc_inbox_send: sent %d tasks to %d at %"PRId64"\n", n, proc, base);
+  ib->rlen[proc] = 0;
+  ib->stats.nsent += n;
+  ib->stats.nbatches++;
+  return n;
+}
+
+
+
+/*
+ * Drop n sent tasks from the front of proc's batch buffer, after a shmem_quiet().
+ */
+static void gtc_inbox_sent(gtc_inbox_t *ib, int proc, int n) {
+  ib->nout[proc] -= n;
+  if (ib->nout[proc] > 0)
+    memmove(ib->outbox[proc], ib->outbox[proc] + (size_t)n * ib->elem_size, (size_t)ib->nout[proc] * ib->elem_size);
+}
+
+
+
+/**
+ * Add a task to the batch for proc's inbox, sending the batch once it is full.
+ *
+ * @param ib   inbox
+ * @param proc destination process
+ * @param e    task to copy in
+ * @param size size of the task, no larger than the slot size
+ */
+void gtc_inbox_push(gtc_inbox_t *ib, int proc, void *e, int size) {
+  GTC_ENTRY();
+  int sent;
+
+  assert(proc != ib->procid);
+  assert(size <= ib->elem_size);
+
+  // the buffer only grows past a batch while proc's inbox is full
+  if (ib->nout[proc] == ib->ncap[proc]) {
+    ib->ncap[proc]   = ib->ncap[proc] ? 2 * ib->ncap[proc] : ib->batch;
+    ib->outbox[proc] = realloc(ib->outbox[proc], (size_t)ib->ncap[proc] * ib->elem_size);
+    if (!ib->outbox[proc]) {
+      gtc_eprintf(DBGERR, "gtc_inbox_push: unable to grow batch buffer to %d tasks\n", ib->ncap[proc]);
+      exit(1);
+    }
+  }
+
+  if (ib->nout[proc] == 0)
+    ib->dirty[ib->ndirty++] = proc;
+
+  memcpy(ib->outbox[proc] + (size_t)ib->nout[proc] * ib->elem_size, e, size);
+  ib->nout[proc]++;
+
+  if (ib->nout[proc] >= ib->batch && (sent = gtc_inbox_send(ib, proc)) > 0) {
+    shmem_quiet();
+    gtc_inbox_sent(ib, proc, sent);
+
+    // drop proc from the dirty list
+    for (int i = 0; ib->nout[proc] == 0 && i < ib->ndirty; i++) {
+      if (ib->dirty[i] == proc) {
+        ib->dirty[i] = ib->dirty[--ib->ndirty];
+        break;
+      }
+    }
+  }
+  GTC_EXIT();
+}
+
+
+
+/**
+ * Send every buffered batch whose destination has room for it.
+ */
+void gtc_inbox_flush(gtc_inbox_t *ib) {
+  GTC_ENTRY();
+  int i, ndirty = 0;
+
+  if (ib->ndirty == 0)
+    GTC_EXIT();
+
+  // sends to different processes overlap, one quiet covers them all
+  for (i = 0; i < ib->ndirty; i++)
+    ib->nsent[i] = gtc_inbox_send(ib, ib->dirty[i]);
+
+  shmem_quiet();
+
+  for (i = 0; i < ib->ndirty; i++) {
+    int proc = ib->dirty[i];
+
+    gtc_inbox_sent(ib, proc, ib->nsent[i]);
+    if (ib->nout[proc] > 0)
+      ib->dirty[ndirty++] = proc;
+  }
+  ib->ndirty = ndirty;
+  GTC_EXIT();
+}
+
+
+
+/*
+ * Consume every published run from our inbox, moving the tasks onto the head of our queue
+ * unless discard is set.
+ */
+static int gtc_inbox_drain_impl(gtc_inbox_t *ib, int discard) {
+  tc_t   *tc   = ib->tc;
+  int64_t head = ib->head, end;
+  int     n    = 0;
+
+  while (head < *(volatile int64_t *)&ib->reserved) {
+    end = (int64_t)shmem_atomic_fetch(gtc_inbox_ready(ib, head % ib->max_size), ib->procid);
+
+    // the next run has been reserved but hasn't landed yet
+    if (end <= head)
+      break;
+
+    while (head < end) {
+      int64_t first = head % ib->max_size;
+      int     part  = end - head;
+
+      if (part > ib->max_size - first)
+        part = ib->max_size - first;
+
+      if (!discard && tc->npriorities == 1)
+        tc->rcb.push_n_head(tc->shared_rb, ib->procid, gtc_inbox_slot(ib, first), part);
+      else if (!discard)
+        // each task goes to its own priority level
+        for (int i = 0; i < part; i++) {
+          task_t *t = (task_t *)gtc_inbox_slot(ib, first + i);
+          tc->rcb.push_n_head(tc->prio_rb[gtc_task_level(tc, t)], ib->procid, t, 1);
+        }
+      head += part;
+      n    += part;
+    }
+
+    // hand the slots back to producers
+    shmem_atomic_set(&ib->head, head, ib->procid);
+  }
+
+  return n;
+}
+
+
+
+/**
+ * Move every published run from our inbox onto the head of our queue.
+ *
+ * @return number of tasks moved
+ */
+int gtc_inbox_drain(gtc_inbox_t *ib) {
+  GTC_ENTRY();
+  int n = gtc_inbox_drain_impl(ib, 0);
+
+  if (n > 0) {
+    ib->stats.nrecvd += n;
+    gtc_lprintf(DBGINBOX, "gtc_progress: Moved %d tasks from inbox to my queue\n", n);
+  }
+  GTC_EXIT(n);
+}
+
+
+
+/**
+ * Throw away unsent batches and everything that has landed in our inbox.  Non-collective, so
+ * runs that are already reserved are still delivered: their owners wait for them.
+ */
+void gtc_inbox_clear(gtc_inbox_t *ib) {
+  GTC_ENTRY();
+  int ndirty = 0;
+
+  for (int i = 0; i < ib->ndirty; i++) {
+    int proc = ib->dirty[i];
+
+    ib->nout[proc] = ib->rlen[proc];
+    if (ib->nout[proc] > 0)
+      ib->dirty[ndirty++] = proc;
+  }
+  ib->ndirty = ndirty;
+
+  gtc_inbox_drain_impl(ib, 1);
+  GTC_EXIT();
+}
+
+
+
+/**
+ * Number of pushed tasks this process is holding: tasks reserved in our inbox that haven't
+ * been drained yet, plus our own batches that haven't been sent.  Approximate, since remote
+ * processes may be reserving slots concurrently.
+ */
+int gtc_inbox_size(gtc_inbox_t *ib) {
+  GTC_ENTRY();
+  int n = *(volatile int64_t *)&ib->reserved - ib->head;
+
+  for (int i = 0; i < ib->ndirty; i++)
+    n += ib->nout[ib->dirty[i]];
+  GTC_EXIT(n);
+}
@@ -0,0 +1,67 @@
+#ifndef __INBOX_H__
+#define __INBOX_H__
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <shmem.h>
+#include <tc.h>
+
+#define GTC_INBOX_SIZE   1024  // default number of task slots in each inbox, override with GTC_INBOX_SIZE
+#define GTC_INBOX_BATCH  16    // default remote adds buffered per destination, override with GTC_INBOX_BATCH
+
+struct gtc_inbox_stats_s {
+  tc_counter_t      nsent;     // tasks pushed to other processes
+  tc_counter_t      nbatches;  // batches sent
+  tc_counter_t      nrecvd;    // tasks drained from our inbox into the queue
+  tc_counter_t      nfull;     // sends deferred because the destination inbox was full
+};
+typedef struct gtc_inbox_stats_s gtc_inbox_stats_t;
+
+/*
+ * Remote task inbox: each process owns a multi-producer, single-consumer ring of fixed-size task
+ * slots.  A producer reserves a run of slots with one atomic fetch-add on reserved, writes the
+ * tasks with non-blocking puts, and then publishes the run by setting ready[first slot] to the
+ * position one past its last slot.  The owner drains published runs in order from head.  A
+ * slot's ready word from an older lap always holds a position <= head, so it never has to be
+ * cleared.
+ */
+struct gtc_inbox_s {
+  int64_t           reserved GTC_CACHE_ALIGNED; // (remote) next slot position to hand out
+  int64_t           head GTC_CACHE_ALIGNED;     // (remote reads) next slot position to drain
+  int               procid;
+  int               nproc;
+  int               elem_size;  // size of a task slot
+  int               max_size;   // number of task slots
+  int               batch;      // remote adds buffered per destination before sending
+  tc_t             *tc;         // (private) owning task collection, drained tasks go to its queue
+
+  u_int8_t        **outbox;     // (private) per destination batch buffers, allocated on first use
+  int              *nout;       // (private) number of tasks in each batch buffer
+  int              *ncap;       // (private) capacity of each batch buffer
+  int64_t          *rbase;      // (private) first position of a run reserved but not yet sent
+  int              *rlen;       // (private) length of that run, 0 if none
+  int              *dirty;      // (private) destinations with a non-empty batch buffer
+  int               ndirty;
+  int              *nsent;      // (private) scratch, tasks sent to each dirty destination by a flush
+
+  gtc_inbox_stats_t stats;      // (private) performance stats
+
+  u_int8_t          q[0] GTC_CACHE_ALIGNED; // (remote) task slots, followed by their ready words
+};
+typedef struct gtc_inbox_s gtc_inbox_t;
+
+#define GTC_INBOX_ALIGN(X)     (((X) + 7) & ~7)
+#define gtc_inbox_slot(IB, I)  ((IB)->q + (int64_t)(I) * (IB)->elem_size)
+#define gtc_inbox_ready(IB, I) ((uint64_t *)((IB)->q + GTC_INBOX_ALIGN((int64_t)(IB)->max_size * (IB)->elem_size)) + (I))
+
+gtc_inbox_t *gtc_inbox_create(int elem_size, int max_size, tc_t *tc);
+void         gtc_inbox_destroy(gtc_inbox_t *ib);
+void         gtc_inbox_reset(gtc_inbox_t *ib);
+
+void         gtc_inbox_push(gtc_inbox_t *ib, int proc, void *e, int size);
+void         gtc_inbox_flush(gtc_inbox_t *ib);
+int          gtc_inbox_drain(gtc_inbox_t *ib);
+void         gtc_inbox_clear(gtc_inbox_t *ib);
+int          gtc_inbox_size(gtc_inbox_t *ib);
+
+#endif /* __INBOX_H__ */
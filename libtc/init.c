@@ -154,15 +154,26 @@ void gtc_bthandler(int sig, siginfo_t *si, void *vctx) {
 void gtc_ldbal_cfg_set(gtc_t gtc, gtc_ldbal_cfg_t *cfg) {
   tc_t *tc = gtc_lookup(gtc);
 
-  assert(cfg->target_selection == TARGET_RANDOM || cfg->target_selection == TARGET_ROUND_ROBIN);
-  assert(cfg->steal_method == STEAL_HALF || cfg->steal_method == STEAL_ALL || cfg->steal_method == STEAL_CHUNK);
+  assert(cfg->steal_method >= 0 && cfg->steal_method < STEAL_NMETHODS);
   assert(cfg->max_steal_retries >= 0);
   assert(cfg->max_steal_attempts_local >= 0);
   assert(cfg->max_steal_attempts_remote >= 0);
   assert(cfg->chunk_size >= 1);
   assert(cfg->local_search_factor >= 0 && cfg->local_search_factor <= 100);
+  assert(cfg->idle_mode >= 0 && cfg->idle_mode < IDLE_NMODES);
+  assert(cfg->idle_pause_max >= 1);
+  assert(cfg->idle_yield_after >= 0 && cfg->idle_sleep_after >= 0);
+  assert(cfg->idle_sleep_ns >= 0 && cfg->idle_sleep_ns < 1000000000);
+  assert(cfg->lifeline_after >= 0);
+  assert(cfg->probe_width >= 1 && cfg->probe_width <= GTC_MAX_PROBE_WIDTH);
+
+  if (gtc_victim_policy(cfg->target_selection) == NULL) {
+    gtc_eprintf(DBGERR, "gtc_ldbal_cfg_set: unknown target selection policy %d\n", cfg->target_selection);
+    exit(1);
+  }
 
-  tc->ldbal_cfg = *cfg;
+  tc->ldbal_cfg     = *cfg;
+  tc->select_victim = gtc_victim_policy(cfg->target_selection);
 }
 
 
@@ -177,9 +188,15 @@ void gtc_ldbal_cfg_get(gtc_t gtc, gtc_ldbal_cfg_t *cfg) {
 
 
 /**
- * Set up a ldbal_cfg struct with the default values.
+ * Set up a ldbal_cfg struct with the default values.  Idle searchers busy-poll by default,
+ * GTC_IDLE_MODE (spin, backoff, or adaptive) opts in to backing off between failed steals.
+ * GTC_STEAL_METHOD (half, greedy, chunk, or work) overrides the default steal method,
+ * GTC_LIFELINES=K waits on lifelines after K failed steals, and GTC_PROBE_WIDTH=K probes
+ * K victims at once before each steal.
  */
 void gtc_ldbal_cfg_init(gtc_ldbal_cfg_t *cfg) {
+  char *envp;
+
   cfg->stealing_enabled    = 1;
   cfg->target_selection    = TARGET_RANDOM;
   cfg->steal_method        = STEAL_HALF;
@@ -189,4 +206,29 @@ void gtc_ldbal_cfg_init(gtc_ldbal_cfg_t *cfg) {
   cfg->max_steal_attempts_remote= 10;
   cfg->chunk_size          = 1;
   cfg->local_search_factor = 75;
+  cfg->idle_mode           = IDLE_SPIN;
+  cfg->idle_pause_max      = 1024;
+  cfg->idle_yield_after    = 64;
+  cfg->idle_sleep_after    = 1024;
+  cfg->idle_sleep_ns       = 50000;
+  cfg->lifeline_after      = 0;
+  cfg->probe_width         = 1;
+
+  if ((envp = getenv("GTC_IDLE_MODE")) != NULL) {
+    for (int m = 0; m < IDLE_NMODES; m++)
+      if (strcasecmp(envp, idle_modes[m]) == 0)
+        cfg->idle_mode = m;
+  }
+
+  if ((envp = getenv("GTC_STEAL_METHOD")) != NULL) {
+    for (int m = 0; m < STEAL_NMETHODS; m++)
+      if (strcasecmp(envp, steal_methods[m]) == 0)
+        cfg->steal_method = m;
+  }
+
+  if ((envp = getenv("GTC_LIFELINES")) != NULL)
+    cfg->lifeline_after = atoi(envp);
+
+  if ((envp = getenv("GTC_PROBE_WIDTH")) != NULL)
+    cfg->probe_width = atoi(envp);
 }
@@ -0,0 +1,156 @@
+/*********************************************************************/
+/*                                                                   */
+/*  lifeline.c - scioto lifeline graph for idle processes            */
+/*    (c) 2021 see COPYRIGHT in top-level                            */
+/*                                                                   */
+/*********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tc.h"
+#include "inbox.h"
+
+/**
+ * Lifeline Semantics:
+ * ==================
+ *
+ * Random stealing keeps every idle process polling until termination, which floods the
+ * network with failed steals once work runs low.  With lifelines (Saraswat et al., PPoPP'11)
+ * a process that has failed lifeline_after steals in a row registers on its lifeline buddies
+ * and stops stealing.  A buddy that has work pushes part of it to every process waiting on
+ * it the next time it makes progress.
+ *
+ * The lifeline graph is a hypercube: the buddies of p are p ^ (1 << i) for every dimension i
+ * where that is a PE.  Clearing the highest bit always gives a lower PE, so the graph is
+ * connected for any number of PEs and work pushed anywhere spreads to every waiting process.
+ * The relation is symmetric, so p registers on buddy b by setting bit i of b's lifelines word
+ * and b knows who to push to from the bit alone.
+ *
+ * Pushed tasks go through the buddy's inbox like a remote add.  They are counted as spawned by
+ * whoever created them and completed by whoever runs them, moving them doesn't change either
+ * count, and termination detection is unaffected.  A process that gets work while still
+ * registered on other buddies may get pushed more later, which is harmless.
+ *
+ * With GTC_TD_MODE=event a waiting process blocks in td_wait() between votes, and the inbox
+ * wakes it when the pushed tasks are published.
+ */
+
+
+
+/**
+ * gtc_lifelines_create - size the lifeline hypercube for a task collection
+ *
+ * @param tc task collection
+ */
+void gtc_lifelines_create(tc_t *tc) {
+  tc->nlifelines = 0;
+  while ((1 << tc->nlifelines) < _c->size)
+    tc->nlifelines++;
+
+  tc->lifeline_buf = gtc_malloc(sizeof(task_t) + tc->max_body_size);
+  gtc_lifelines_reset(tc);
+}
+
+
+
+/**
+ * gtc_lifelines_destroy - free the lifeline scratch task
+ *
+ * @param tc task collection
+ */
+void gtc_lifelines_destroy(tc_t *tc) {
+  free(tc->lifeline_buf);
+}
+
+
+
+/**
+ * gtc_lifelines_reset - forget who is waiting on us.  A registration left over from the
+ *   last phase only leads to a spurious push.
+ *
+ * @param tc task collection
+ */
+void gtc_lifelines_reset(tc_t *tc) {
+  tc->lifelines = 0;
+}
+
+
+
+/**
+ * gtc_lifeline_register - ask our lifeline buddies to push work to us, the caller stops
+ *   stealing after this
+ *
+ * @param gtc task collection
+ */
+void gtc_lifeline_register(gtc_t gtc) {
+  GTC_ENTRY();
+  tc_t *tc = gtc_lookup(gtc);
+
+  for (int i = 0; i < tc->nlifelines; i++) {
+    int b = _c->rank ^ (1 << i);
+    if (b < _c->size)
+      shmem_atomic_or(&tc->lifelines, (uint64_t)1 << i, b);
+  }
+
+  tc->ct.lifeline_waits++;
+  gtc_lprintf(DBGGET, " Thread %d: waiting on %d lifelines\n", _c->rank, tc->nlifelines);
+  GTC_EXIT();
+}
+
+
+
+/**
+ * gtc_lifeline_push - give half of our work to each buddy waiting on us, highest priority
+ *   levels first.  Registrations stay pending until we have at least two tasks.
+ *
+ * @param gtc task collection
+ */
+void gtc_lifeline_push(gtc_t gtc) {
+  GTC_ENTRY();
+  tc_t    *tc = gtc_lookup(gtc);
+  uint64_t waiting;
+  int      navail = 0;
+
+  if (tc->ldbal_cfg.lifeline_after == 0)
+    GTC_EXIT();
+
+  for (int l = 0; l < tc->npriorities; l++)
+    navail += tc->rcb.work_avail(tc->prio_rb[l]);
+
+  if (navail < 2 || shmem_atomic_fetch(&tc->lifelines, _c->rank) == 0)
+    GTC_EXIT();
+
+  waiting = shmem_atomic_swap(&tc->lifelines, (uint64_t)0, _c->rank);
+
+  for (int i = 0; i < tc->nlifelines && navail >= 2; i++) {
+    int b = _c->rank ^ (1 << i);
+    int n = navail / 2, k = 0;
+
+    if (!(waiting & ((uint64_t)1 << i)))
+      continue;
+
+    // no point sending more than the buddy's inbox can take at once
+    if (n > tc->inbox->max_size)
+      n = tc->inbox->max_size;
+
+    for (int l = tc->npriorities-1; l >= 0 && k < n; l--) {
+      while (k < n && tc->rcb.pop_head(tc->prio_rb[l], _c->rank, tc->lifeline_buf)) {
+        gtc_inbox_push(tc->inbox, b, tc->lifeline_buf, sizeof(task_t) + gtc_task_body_size(tc->lifeline_buf));
+        k++;
+      }
+    }
+
+    navail -= k;
+    tc->ct.lifeline_pushes++;
+    tc->ct.lifeline_tasks += k;
+    waiting &= ~((uint64_t)1 << i);
+  }
+
+  // buddies we didn't get to are still waiting
+  if (waiting)
+    shmem_atomic_or(&tc->lifelines, waiting, _c->rank);
+
+  gtc_inbox_flush(tc->inbox);
+  GTC_EXIT();
+}
@@ -5,6 +5,8 @@
 /*                                                       */
 /*********************************************************/
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #include "tc.h"
@@ -34,6 +36,36 @@ unsigned long synch_mutex_lock_ncalls_contention = 0;
 unsigned long synch_mutex_lock_ncalls            = 0;
 
 
+/* lock implementation requested through the environment */
+static synch_mutex_type_t synch_mutex_select(void) {
+  char *type = getenv("GTC_MUTEX");
+
+  if (!type || !strcmp(type, "swap"))
+    return SynchMutexSwap;
+  if (!strcmp(type, "mcs"))
+    return SynchMutexMCS;
+
+  gtc_eprintf(DBGERR, "synch_mutex_init: unknown GTC_MUTEX \"%s\" (swap or mcs)\n", type);
+  exit(1);
+}
+
+
+/* record how many tries a lock acquisition took */
+static inline void synch_mutex_count(unsigned long nattempts) {
+  synch_mutex_lock_ncalls++;
+  synch_mutex_lock_nattempts_last     = nattempts;
+  synch_mutex_lock_nattempts_sum     += nattempts;
+  synch_mutex_lock_nattempts_squares += (double)nattempts * nattempts;
+
+  if (nattempts > synch_mutex_lock_nattempts_max)
+    synch_mutex_lock_nattempts_max = nattempts;
+  if (synch_mutex_lock_ncalls == 1 || nattempts < synch_mutex_lock_nattempts_min)
+    synch_mutex_lock_nattempts_min = nattempts;
+  if (nattempts > 1)
+    synch_mutex_lock_ncalls_contention++;
+}
+
+
 /** Initialize a local mutex.
   *
   *  @param[in] lock Array that holds current lock state for every processor.
@@ -41,12 +73,90 @@ unsigned long synch_mutex_lock_ncalls            = 0;
   */
 void synch_mutex_init(synch_mutex_t *m) {
   GTC_ENTRY();
+  m->type  = synch_mutex_select();
   m->locks = gtc_shmem_calloc(shmem_n_pes(), sizeof(long));
+  m->node  = gtc_shmem_calloc(1, sizeof(synch_mcs_node_t));
   GTC_EXIT();
 }
 
 
 
+/** Free a mutex.
+  *
+  *  NOTE: This must be a collective call
+  */
+void synch_mutex_destroy(synch_mutex_t *m) {
+  GTC_ENTRY();
+  shmem_free(m->node);
+  shmem_free(m->locks);
+  GTC_EXIT();
+}
+
+
+
+/** Name of the lock implementation selected by the environment.
+  */
+char *synch_mutex_name(void) {
+  return synch_mutex_select() == SynchMutexMCS ? "MCS Queue Locks" : "PtlSwap Spinlocks";
+}
+
+
+
+/*
+ * MCS queue lock.  The lock word on proc holds the PE+1 of the last waiter.  A new waiter swaps
+ * itself in as the tail, links itself behind its predecessor's node and then spins on its own
+ * node until the predecessor hands the lock over, so each handoff is one remote write instead of
+ * every waiter retrying a swap on proc.  Each PE has a single node per mutex, so a PE can hold
+ * or wait for only one proc's instance of a given mutex at a time.
+ */
+static void synch_mutex_mcs_lock(synch_mutex_t *m, int proc) {
+  long pred, me = shmem_my_pe() + 1;
+
+  shmem_atomic_set(&m->node->next,   0L, shmem_my_pe());
+  shmem_atomic_set(&m->node->locked, 1L, shmem_my_pe());
+  shmem_quiet(); // our node is reset before a predecessor can find it and hand over
+
+  pred = shmem_atomic_swap(&m->locks[proc], me, proc);
+
+  if (pred != 0) {
+    shmem_atomic_set(&m->node->next, me, pred - 1);
+    shmem_long_wait_until(&m->node->locked, SHMEM_CMP_EQ, 0);
+  }
+
+  synch_mutex_count(pred != 0 ? 2 : 1);
+}
+
+
+static int synch_mutex_mcs_trylock(synch_mutex_t *m, int proc) {
+  long me = shmem_my_pe() + 1;
+
+  shmem_atomic_set(&m->node->next, 0L, shmem_my_pe());
+  return shmem_atomic_compare_swap(&m->locks[proc], 0L, me, proc) == 0;
+}
+
+
+static void synch_mutex_mcs_unlock(synch_mutex_t *m, int proc) {
+  long next, me = shmem_my_pe() + 1;
+
+  // Everything done under the lock must be visible to the next holder
+  shmem_quiet();
+
+  next = shmem_atomic_fetch(&m->node->next, shmem_my_pe());
+  if (next == 0) {
+    // No known successor, release the lock if we are still the tail
+    if (shmem_atomic_compare_swap(&m->locks[proc], me, 0L, proc) == me)
+      return;
+
+    // Someone swapped in behind us, wait for them to link in
+    shmem_long_wait_until(&m->node->next, SHMEM_CMP_NE, 0);
+    next = shmem_atomic_fetch(&m->node->next, shmem_my_pe());
+  }
+
+  shmem_atomic_set(&m->node->locked, 0L, next - 1);
+}
+
+
+
 /** Lock the given mutex on the given processor.  Blocks until mutex is acquired.
   *
   *  @param[in] lock Array that holds current lock state for every processor.
@@ -59,6 +169,14 @@ void synch_mutex_lock(synch_mutex_t *m, int proc) {
 
   gtc_lprintf(DBGSYNCH, "synch_mutex_lock (%p, %d)\n", m, proc);
 
+  if (m->type == SynchMutexMCS) {
+    UNUSED(lock_val);
+    UNUSED(nattempts);
+    UNUSED(backoff);
+    synch_mutex_mcs_lock(m, proc);
+    GTC_EXIT();
+  }
+
 #ifdef USING_SHMEM_LOCKS
 
   UNUSED(lock_val);
@@ -85,6 +203,8 @@ void synch_mutex_lock(synch_mutex_t *m, int proc) {
 
   } while (lock_val != SYNCH_MUTEX_UNLOCKED);
 
+  synch_mutex_count(nattempts);
+
 #endif /* USING_SHMEM_LOCKS */
   GTC_EXIT();
 }
@@ -103,6 +223,11 @@ int synch_mutex_trylock(synch_mutex_t *m, int proc) {
 
   gtc_lprintf(DBGSYNCH, "synch_mutex_trylock (%p, %d)\n", m, proc);
 
+  if (m->type == SynchMutexMCS) {
+    UNUSED(lock_val);
+    return synch_mutex_mcs_trylock(m, proc);
+  }
+
 #ifdef USING_SHMEM_LOCKS
   UNUSED(lock_val);
   ret = shmem_test_lock(&m->locks[proc]);
@@ -126,6 +251,11 @@ void synch_mutex_unlock(synch_mutex_t *m, int proc) {
   GTC_ENTRY();
   gtc_lprintf(DBGSYNCH, "synch_mutex_unlock (%p, %d)\n", m, proc);
 
+  if (m->type == SynchMutexMCS) {
+    synch_mutex_mcs_unlock(m, proc);
+    GTC_EXIT();
+  }
+
 #ifdef USING_SHMEM_LOCKS
 
   shmem_clear_lock(&m->locks[proc]);
@@ -5,8 +5,25 @@
 #pragma once
 
 #define SYNCH_RMW_OP ARMCI_SWAP
+
+/** Lock implementation, chosen at init time with GTC_MUTEX=swap|mcs */
+enum synch_mutex_type_e {
+  SynchMutexSwap,     // test-and-swap spin on the lock word with linear backoff
+  SynchMutexMCS       // MCS queue lock, waiters spin on their own qnode
+};
+typedef enum synch_mutex_type_e synch_mutex_type_t;
+
+/** MCS queue node, one per PE per mutex.  Links are PE+1, 0 means none. */
+struct synch_mcs_node_s {
+  long locked;
+  long next;
+};
+typedef struct synch_mcs_node_s synch_mcs_node_t;
+
 struct synch_mutex_s {
-  long *locks;
+  long               *locks;  // lock word on each proc: locked flag, or MCS tail (PE+1 of last waiter)
+  synch_mcs_node_t   *node;   // (symmetric) my MCS queue node
+  synch_mutex_type_t  type;
 };
 
 typedef struct synch_mutex_s synch_mutex_t;
@@ -21,6 +38,8 @@ extern unsigned long synch_mutex_lock_ncalls_contention;
 extern unsigned long synch_mutex_lock_ncalls;
 
 void synch_mutex_init(synch_mutex_t *lock);
+void synch_mutex_destroy(synch_mutex_t *lock);
+char *synch_mutex_name(void);
 void synch_mutex_lock(synch_mutex_t *lock, int proc);
 int  synch_mutex_trylock(synch_mutex_t *lock, int proc);
 void synch_mutex_unlock(synch_mutex_t *lock, int proc);
@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <stdatomic.h>
 
 #include <mutex.h>
 
@@ -19,6 +20,12 @@
 #define LOCKQUEUE 0x000000000000000
 #define FullQueue 1
 #define EmptyQueue 0
+
+// steal_val layout sanity (see saws_shrb.h)
+_Static_assert(SAWS_ASTEALS_BITS >= 16, "SAWS_INDEX_BITS too large: fewer than 16 bits left for asteals");
+_Static_assert(SAWS_MAX_STEALS_PER_EPOCH > SAWS_INDEX_BITS, "steal-half schedule of a full queue doesn't fit in an epoch");
+_Static_assert(SAWS_MAX_EPOCHS >= 2, "SAWS needs at least two epochs to switch on reacquire");
+_Static_assert(SAWS_MAX_EPOCHS <= SAWS_EPOCH_DISABLED, "SAWS_EPOCH_BITS too small for SAWS_MAX_EPOCHS");
 /**
  * SHMEM Atomic Work Stealing (SAWS) Task Queue
  * ================================================
@@ -70,6 +77,8 @@ saws_shrb_t *saws_shrb_create(int elem_size, int max_size, tc_t *tc) {
   int procid, nproc;
   uint32_t *targets;
   char *rec = NULL;
+  int varlen = 0;
+  size_t qbytes;
   setbuf(stdout, NULL);
 
   procid = shmem_my_pe();
@@ -77,8 +86,25 @@ saws_shrb_t *saws_shrb_create(int elem_size, int max_size, tc_t *tc) {
 
   gtc_lprintf(DBGSHRB, "  Thread %d: saws_shrb_create()\n", procid);
 
-  // Allocate the struct and the buffer contiguously in shared space
-  rb = gtc_shmem_malloc(sizeof(saws_shrb_t) + elem_size*max_size);
+  // tail and itasks are packed into steal_val, larger queues can't be encoded
+  if (max_size > SAWS_MAX_QUEUE_SIZE) {
+    gtc_eprintf(DBGERR, "saws_shrb_create: queue size %d exceeds SAWS limit of %"PRId64" (rebuild with larger SAWS_INDEX_BITS)\n",
+        max_size, SAWS_MAX_QUEUE_SIZE);
+    exit(1);
+  }
+
+  // variable-length slots need the byte ring, its slack and the index ring, see saws_slot_t
+  rec = getenv("GTC_QUEUE_VARLEN");
+  if (rec)
+    varlen = atoi(rec);
+  if (varlen)
+    qbytes = (size_t)(max_size + 1)*SAWS_VARLEN_ALIGN(elem_size) + (size_t)max_size*sizeof(saws_slot_t);
+  else
+    qbytes = (size_t)elem_size*max_size;
+
+  // Allocate the struct and the buffer contiguously in shared space, line aligned so the
+  // padding in saws_shrb_t keeps remotely updated words apart
+  rb = gtc_shmem_align(GTC_CACHE_LINE, sizeof(saws_shrb_t) + qbytes);
 
   targets = (uint32_t *) gtc_calloc(nproc, sizeof(uint32_t));
 
@@ -90,9 +116,28 @@ saws_shrb_t *saws_shrb_create(int elem_size, int max_size, tc_t *tc) {
   rec = getenv("GTC_RECLAIM_FREQ");
   if (rec)
     rb->reclaimfreq = atoi(rec);
+  rb->completion  = SAWSCompletionCounter;
+  rec = getenv("GTC_SAWS_COMPLETION");
+  if (rec && !strcmp(rec, "scan"))
+    rb->completion = SAWSCompletionScan;
+  rb->pipeline    = 0; // task collections turn this on, see gtc_create_saws()
+  rb->varlen      = varlen;
+  rb->bcap        = varlen ? (int64_t)max_size*SAWS_VARLEN_ALIGN(elem_size) : 0;
+  rb->vslot       = varlen ? gtc_calloc(max_size, sizeof(saws_slot_t)) : NULL;
+  rb->elem_len    = NULL; // task collections set this, see gtc_create_saws()
+
+  // keep steal traffic on its own context so completing a steal doesn't
+  // wait on unrelated communication from this process
+  if (shmem_ctx_create(SHMEM_CTX_PRIVATE, &rb->ctx) != 0)
+    rb->ctx = SHMEM_CTX_DEFAULT;
 
   rb->targets     = targets;
+  rb->peers       = gtc_calloc(nproc, sizeof(void *));
+  rb->local_atomics = gtc_map_peers(rb, rb->peers);
   rb->tc          = tc;
+  rb->stats       = gtc_calloc(1, sizeof(saws_shrb_stats_t));
+  rb->spill       = NULL;
+  rb->spill_max   = 0;
 
   saws_shrb_reset(rb);
 
@@ -106,26 +151,33 @@ saws_shrb_t *saws_shrb_create(int elem_size, int max_size, tc_t *tc) {
 
 void saws_shrb_reset(saws_shrb_t *rb) {
   GTC_ENTRY();
+  // finish our last pipelined steal, the private context isn't covered by barriers
+  saws_shrb_steal_finish(rb);
+  shmem_ctx_quiet(rb->ctx);
+
   rb->nlocal     = 0;
   rb->tail       = 0;
   rb->vtail      = 0;
   rb->steal_val  = 0;
   rb->cur        = 0;
-  rb->last       = 1;
+  rb->oldest     = 0;
   rb->split      = 0;
   rb->waiting    = 0;
   rb->nshared    = 0;
-  rb->nrelease   = 0;
-  rb->nreacquire = 0;
-  rb->nwaited    = 0;
-  rb->nreclaimed = 0;
-  uint64_t sv = 3;
-  rb->steal_val |= sv << 38;
-  //rb->steal_val = sv;
-
-  memset(rb->claimed, 0, sizeof(rb->claimed));
+  rb->nspill     = 0;
+  rb->spill_hwm  = 0;
+  rb->bhead      = 0;
+
+  rb->stats->nrelease   = 0;
+  rb->stats->nreacquire = 0;
+  rb->stats->nwaited    = 0;
+  rb->stats->ndeferred  = 0;
+  rb->stats->nreclaimed = 0;
+  rb->stats->nspilled   = 0;
+  rb->steal_val  = SAWS_EPOCH_MASK << SAWS_EPOCH_SHIFT; // nothing released yet, steals disabled
+
   memset(rb->completed, 0, sizeof(rb->completed));
-  rb->completed[rb->last].done = 1;
+  memset(&rb->pending, 0, sizeof(rb->pending));
 
   for(int i = 0; i < rb->nproc; i++)
     rb->targets[i] = FullQueue;
@@ -136,7 +188,19 @@ void saws_shrb_reset(saws_shrb_t *rb) {
 
 void saws_shrb_destroy(saws_shrb_t *rb) {
   GTC_ENTRY();
+  saws_shrb_steal_finish(rb);
+  if (rb->ctx != SHMEM_CTX_DEFAULT) {
+    shmem_ctx_quiet(rb->ctx);
+    shmem_ctx_destroy(rb->ctx);
+  }
   free(rb->targets);
+  free(rb->peers);
+  free(rb->stats);
+  if (rb->spill)
+    free(rb->spill);
+  if (rb->vslot)
+    free(rb->vslot);
+  synch_mutex_destroy(&rb->lock);
   shmem_free(rb);
   GTC_EXIT();
 }
@@ -144,6 +208,67 @@ void saws_shrb_destroy(saws_shrb_t *rb) {
 
 /*================== HELPER FUNCTIONS ===================*/
 
+
+/*
+ * Node-local fast path: a victim whose queue is mapped into our address space (shmem_ptr) is
+ * read with memcpy instead of RMA.  steal_val and the completion counters only switch to CPU
+ * atomics when every queue is mapped, so they never race with off-node NIC atomics.
+ */
+
+/* proc's copy of the symmetric address sym within its queue */
+static inline void *saws_shrb_peer(saws_shrb_t *rb, void *sym, int proc) {
+  return (u_int8_t *)rb->peers[proc] + ((u_int8_t *)sym - (u_int8_t *)rb);
+}
+
+static inline uint64_t saws_stealval_fetch(saws_shrb_t *rb, int proc) {
+  if (rb->local_atomics)
+    return atomic_load((_Atomic uint64_t *)saws_shrb_peer(rb, &rb->steal_val, proc));
+  return shmem_atomic_fetch(&rb->steal_val, proc);
+}
+
+static inline uint64_t saws_stealval_fetch_add(saws_shrb_t *rb, uint64_t val, int proc) {
+  if (rb->local_atomics)
+    return atomic_fetch_add((_Atomic uint64_t *)saws_shrb_peer(rb, &rb->steal_val, proc), val);
+  return shmem_atomic_fetch_add(&rb->steal_val, val, proc);
+}
+
+static inline uint64_t saws_stealval_fetch_or(saws_shrb_t *rb, uint64_t val) {
+  if (rb->local_atomics)
+    return atomic_fetch_or((_Atomic uint64_t *)&rb->steal_val, val);
+  return shmem_atomic_fetch_or(&rb->steal_val, val, rb->procid);
+}
+
+static inline void saws_stealval_set(saws_shrb_t *rb, uint64_t val) {
+  if (rb->local_atomics)
+    atomic_store((_Atomic uint64_t *)&rb->steal_val, val);
+  else
+    shmem_atomic_set(&rb->steal_val, val, rb->procid);
+}
+
+/* tell proc that ntasks of steal index in epoch have landed */
+static inline void saws_shrb_complete(saws_shrb_t *rb, shmem_ctx_t ctx, int epoch, int index, int ntasks, int proc) {
+  if (rb->local_atomics) {
+    atomic_fetch_add((_Atomic int *)saws_shrb_peer(rb, &rb->completed[epoch].status[index].ntasks, proc), ntasks);
+    if (rb->completion == SAWSCompletionCounter)
+      atomic_fetch_add((_Atomic int64_t *)saws_shrb_peer(rb, &rb->completed[epoch].ncompleted, proc), ntasks);
+    return;
+  }
+  shmem_ctx_int_atomic_add(ctx, &rb->completed[epoch].status[index].ntasks, ntasks, proc);
+  if (rb->completion == SAWSCompletionCounter)
+    shmem_ctx_long_atomic_add(ctx, (long *)&rb->completed[epoch].ncompleted, ntasks, proc);
+}
+
+/* copy nbytes at symmetric address src on proc, memcpy if proc is mapped */
+static inline void saws_shrb_getmem(saws_shrb_t *rb, shmem_ctx_t ctx, void *dst, void *src, size_t nbytes, int proc, int blocking) {
+  if (rb->peers[proc])
+    memcpy(dst, saws_shrb_peer(rb, src, proc), nbytes);
+  else if (blocking)
+    shmem_ctx_getmem(ctx, dst, src, nbytes, proc);
+  else
+    shmem_ctx_getmem_nbi(ctx, dst, src, nbytes, proc);
+}
+
+
 void saws_shrb_print(saws_shrb_t *rb) {
   GTC_ENTRY();
   printf("rb: %p {\n", rb);
@@ -155,13 +280,15 @@ void saws_shrb_print(saws_shrb_t *rb) {
   printf("   tail      = %"PRId64"\n", rb->tail);
   printf("   max_size  = %d\n", rb->max_size);
   printf("   elem_size = %d\n", rb->elem_size);
+  printf("   varlen    = %d (bhead %"PRId64" of %"PRId64")\n", rb->varlen, rb->bhead, rb->bcap);
   printf("   local_size = %d\n", saws_shrb_local_size(rb));
   printf("   shared_size= %d\n", saws_shrb_shared_size(rb));
   printf("   public_size= %d\n", saws_shrb_public_size(rb));
   printf("   size       = %d\n", saws_shrb_size(rb));
-  printf("   a_steals   = %ld\n", (rb->steal_val >> 40));
-  printf("   i_tasks    = %ld\n", ((rb->steal_val >> 19) & 0x1F));
-  printf("   vtail      = %ld\n", rb->steal_val & 0x00000000007FFFF);
+  printf("   spill      = %d (hwm %d)\n", rb->nspill, rb->spill_hwm);
+  printf("   a_steals   = %ld\n", saws_stealval_asteals(rb->steal_val));
+  printf("   i_tasks    = %ld\n", saws_stealval_itasks(rb->steal_val));
+  printf("   vtail      = %ld\n", saws_stealval_tail(rb->steal_val));
   printf("   current epoch = %d\n", rb->cur);
   printf("}\n");
   GTC_EXIT();
@@ -170,55 +297,196 @@ void saws_shrb_print(saws_shrb_t *rb) {
 void print_epoch(saws_shrb_t *rb) {
   GTC_ENTRY();
   printf("\nprocid    = %d\n", rb->procid);
-  int c = rb->cur;
-  int x = 0;
-ag:
-  printf("epoch   = %d\n",c);
-  printf("  itasks    = %ld\n", rb->completed[c].itasks);
-  printf("  vtail     = %ld\n", rb->completed[c].vtail);
-  printf("  done?     = %d\n", rb->completed[c].done);
-  printf("  maxsteals = %d\n", rb->completed[c].maxsteals);
-  printf("  status: ");
-  for (int i = 0; i < rb->completed[c].maxsteals; i++)
-    printf(" [%d] ", rb->completed[c].status[i]);
-  printf("\nprev: \n");
-  if (x == 0) { c = rb->last; x = 1; goto ag;}
+  // walk the epoch ring from the current epoch back to the oldest unretired one
+  for (int c = rb->cur, x = 0; x < SAWS_MAX_EPOCHS; c = (c + SAWS_MAX_EPOCHS - 1) % SAWS_MAX_EPOCHS, x++) {
+    printf("epoch   = %d\n",c);
+    printf("  itasks    = %ld\n", rb->completed[c].itasks);
+    printf("  vtail     = %ld\n", rb->completed[c].vtail);
+    printf("  done?     = %d\n", rb->completed[c].done);
+    printf("  maxsteals = %d\n", rb->completed[c].maxsteals);
+    printf("  status: ");
+    for (int i = 0; i < rb->completed[c].maxsteals; i++)
+      printf(" [%d] ", rb->completed[c].status[i].ntasks);
+    if (c == rb->oldest)
+      break;
+    printf("\nprev: \n");
+  }
+  printf("\n");
   GTC_EXIT();
 }
 
 static inline uint64_t saws_set_stealval(int64_t valid, uint64_t itasks, int64_t tail) {
   gtc_lprintf(DBGSHRB, "setting steal_val: valid: %d itasks: %d tail: %d\n", valid, itasks, tail);
   uint64_t steal_val = 0;
-  steal_val   |= valid << 38;
-  steal_val   |= itasks << 19;
-  steal_val   |= tail;
+  assert(itasks <= SAWS_INDEX_MASK && tail >= 0 && tail <= (int64_t)SAWS_INDEX_MASK);
+  steal_val   |= (uint64_t)valid << SAWS_EPOCH_SHIFT;
+  steal_val   |= itasks << SAWS_ITASKS_SHIFT;
+  steal_val   |= (uint64_t)tail;
   return steal_val;
 }
 
 static inline uint64_t saws_get_stealval(uint64_t steal_val, uint64_t *asteals, uint64_t *itasks, int64_t *tail) {
   uint64_t valid;
-  *asteals   =    (steal_val >> 40)  & 0x0000000000FFFFFF;
-  valid      =    (steal_val >> 38)  & 0x0000000000000003;
-  *itasks    =    (steal_val >> 19)  & 0x000000000007FFFF;
-  *tail      =    steal_val          & 0x000000000007FFFF;
+  *asteals   =    saws_stealval_asteals(steal_val);
+  valid      =    saws_stealval_epoch(steal_val);
+  *itasks    =    saws_stealval_itasks(steal_val);
+  *tail      =    saws_stealval_tail(steal_val);
   return valid;
 }
 
 
 static inline uint64_t saws_disable_steals(saws_shrb_t *rb) {
-  static uint64_t val = SAWS_MAX_EPOCHS << 38;
-  return shmem_atomic_fetch_or(&rb->steal_val, val, rb->procid);
+  static uint64_t val = SAWS_EPOCH_DISABLED << SAWS_EPOCH_SHIFT;
+  return saws_stealval_fetch_or(rb, val);
+}
+
+/*
+ * Claim schedule step: the number of tasks the next steal takes when remaining tasks of the
+ * epoch are still unclaimed.  Owner and thieves both use this to derive the schedule, new
+ * steal methods only need a case here.
+ */
+static inline uint64_t saws_claim_volume(saws_shrb_t *rb, uint64_t remaining) {
+  uint64_t chunk;
+
+  switch (rb->tc->ldbal_cfg.steal_method) {
+    case STEAL_ALL:
+      return remaining;
+    case STEAL_CHUNK:
+      chunk = (rb->tc->ldbal_cfg.chunk_size > 0) ? rb->tc->ldbal_cfg.chunk_size : 1;
+      return (remaining < chunk) ? remaining : chunk;
+    case STEAL_HALF:
+    default:
+      return (remaining > 1) ? remaining >> 1 : remaining;
+  }
+}
+
+/*
+ * Largest release whose claim schedule fits in a completion array.
+ */
+static inline uint64_t saws_max_release(saws_shrb_t *rb) {
+  if (rb->tc->ldbal_cfg.steal_method == STEAL_CHUNK)
+    return saws_claim_volume(rb, SAWS_MAX_QUEUE_SIZE) * SAWS_MAX_STEALS_PER_EPOCH;
+  if (rb->tc->ldbal_cfg.steal_method == STEAL_WORK)
+    return MIN(SAWS_MAX_QUEUE_SIZE, (int64_t)SAWS_SCHED_NTASKS_MASK);
+  return SAWS_MAX_QUEUE_SIZE;
+}
+
+/*
+ * Fill in the claim schedule for an epoch of itasks tasks.
+ *
+ * @return the number of steals needed to claim the whole epoch
+ */
+static inline int saws_build_schedule(saws_shrb_t *rb, uint64_t itasks, int *offset) {
+  uint64_t claimed = 0;
+  int k;
+
+  offset[0] = 0;
+  for (k = 0; claimed < itasks; k++) {
+    claimed += saws_claim_volume(rb, itasks - claimed);
+    offset[k+1] = claimed;
+  }
+  assert(k <= SAWS_MAX_STEALS_PER_EPOCH);
+  return k;
 }
 
-static inline int saws_max_steals(uint64_t itasks) {
-  uint32_t curr,cnt, total = 0;
+/* the task in queue slot idx, varlen records are found through the slot's index entry */
+static inline task_t *saws_shrb_task(saws_shrb_t *rb, int64_t idx) {
+  if (rb->varlen)
+    return (task_t *)(rb->q + saws_shrb_slot_addr(rb, idx)->off);
+  return (task_t *)saws_shrb_elem_addr(rb, rb->procid, idx);
+}
 
-  for (cnt = 0, curr = itasks; total != itasks; cnt++) {
-    curr = (curr != 1) ? curr >> 1 : 1;
-    total += curr;
-    curr = itasks - total;
+/*
+ * Fill in a STEAL_WORK claim schedule: each steal takes the oldest tasks that hold at least
+ * half of the estimated work still unclaimed, and the last step allowed takes everything left.
+ *
+ * @return the number of steals needed to claim the whole epoch
+ */
+static inline int saws_build_work_schedule(saws_shrb_t *rb, saws_completion_t *epoch) {
+  double   left = 0.0, work;
+  uint64_t claimed = 0, n;
+  int      k;
+
+  for (uint64_t i = 0; i < epoch->itasks; i++)
+    left += gtc_task_cost(rb->tc, saws_shrb_task(rb, (epoch->vtail + i) % rb->max_size));
+
+  epoch->offset[0] = 0;
+  for (k = 0; claimed < epoch->itasks; k++) {
+    if (k == SAWS_MAX_STEALS_PER_EPOCH-1) {
+      n = epoch->itasks - claimed;
+    } else {
+      for (n = 0, work = 0.0; claimed + n < epoch->itasks && (n == 0 || work < left/2); n++)
+        work += gtc_task_cost(rb->tc, saws_shrb_task(rb, (epoch->vtail + claimed + n) % rb->max_size));
+      left -= work;
+    }
+    epoch->sched[k]    = saws_sched_pack(claimed, epoch->vtail, n);
+    claimed           += n;
+    epoch->offset[k+1] = claimed;
   }
-  return cnt;
+  for (int i = k; i < SAWS_MAX_STEALS_PER_EPOCH; i++)
+    epoch->sched[i] = 0;
+  return k;
+}
+
+/*
+ * Thief side lookup of steal k in an epoch of itasks tasks.
+ *
+ * @param offset  set to the number of tasks claimed by steals 0..k-1
+ * @return        the number of tasks steal k claims, 0 if the epoch is exhausted
+ */
+static inline uint64_t saws_claim(saws_shrb_t *rb, uint64_t itasks, uint64_t k, int64_t *offset) {
+  uint64_t claimed = 0;
+
+  for (; k > 0 && claimed < itasks; k--)
+    claimed += saws_claim_volume(rb, itasks - claimed);
+  *offset = claimed;
+  return saws_claim_volume(rb, itasks - claimed);
+}
+
+/*
+ * Thief side lookup of steal k in a STEAL_WORK epoch, fetched from the victim's schedule.
+ *
+ * @param offset  set to the number of tasks claimed by steals 0..k-1
+ * @return        the number of tasks steal k claims, 0 if the epoch is exhausted
+ */
+static inline uint64_t saws_claim_work(saws_shrb_t *rb, int proc, int epoch, uint64_t k, int64_t vtail, uint64_t itasks, int64_t *offset) {
+  uint64_t s;
+
+  *offset = itasks;
+  if (k >= SAWS_MAX_STEALS_PER_EPOCH)
+    return 0;
+
+  if (rb->local_atomics)
+    s = atomic_load((_Atomic uint64_t *)saws_shrb_peer(rb, &rb->completed[epoch].sched[k], proc));
+  else
+    s = shmem_atomic_fetch(&rb->completed[epoch].sched[k], proc);
+
+  if (saws_sched_vtail(s) != (uint64_t)vtail || saws_sched_offset(s) + saws_sched_ntasks(s) > itasks)
+    return 0;
+  *offset = saws_sched_offset(s);
+  return saws_sched_ntasks(s);
+}
+
+/*
+ * Start a new steal epoch in the current completion array and publish it to thieves.
+ */
+static inline void saws_shrb_open_epoch(saws_shrb_t *rb, uint64_t itasks, int64_t vtail) {
+  saws_completion_t *epoch = &rb->completed[rb->cur];
+
+  epoch->itasks     = itasks;
+  epoch->vtail      = vtail;
+  epoch->wsum       = 0;
+  epoch->watermark  = 0;
+  epoch->done       = 0;
+  epoch->ncompleted = 0;
+  if (rb->tc->ldbal_cfg.steal_method == STEAL_WORK)
+    epoch->maxsteals = saws_build_work_schedule(rb, epoch);
+  else
+    epoch->maxsteals = saws_build_schedule(rb, itasks, epoch->offset);
+  // only the claimable status lines, each one is a full cache line
+  for (int i = 0; i < epoch->maxsteals; i++)
+    epoch->status[i].ntasks = 0;
+  saws_stealval_set(rb, saws_set_stealval(rb->cur, itasks, vtail));
 }
 
 
@@ -226,6 +494,16 @@ static inline int saws_max_steals(uint64_t itasks) {
 /*==================== STATE QUERIES ====================*/
 
 
+/*
+ * Anything that moves the head or the split has to wait for a pipelined steal to land first.
+ */
+static inline void saws_shrb_settle(saws_shrb_t *rb) {
+  if (rb->pending.ntasks)
+    saws_shrb_steal_finish(rb);
+}
+
+
+
 int saws_shrb_head(saws_shrb_t *rb) {
   return (rb->split + rb->nlocal - 1) % rb->max_size;
 }
@@ -268,7 +546,42 @@ int saws_shrb_public_size(saws_shrb_t *rb) {
 
 int saws_shrb_size(void *b) {
   saws_shrb_t *rb = (saws_shrb_t *)b;
-  return saws_shrb_local_size(rb) + saws_shrb_shared_size(rb);
+  return saws_shrb_local_size(rb) + saws_shrb_shared_size(rb) + rb->nspill;
+}
+
+
+
+/*
+ * Probe n victims at once: their steal words are read with non-blocking gets and one quiet,
+ * so the round trips overlap.  Sizes are the tasks left unclaimed in each victim's epoch.
+ * Victims seen with work go back to FullQueue so the steal that follows claims directly.
+ */
+void saws_shrb_probe_n(void *b, int *procs, int n, int *sizes) {
+  saws_shrb_t *rb = (saws_shrb_t *)b;
+  uint64_t     sv[GTC_MAX_PROBE_WIDTH], asteals, itasks;
+  int64_t      tail, claimed;
+
+  assert(n <= GTC_MAX_PROBE_WIDTH);
+
+  for (int i = 0; i < n; i++) {
+    if (rb->local_atomics)
+      sv[i] = saws_stealval_fetch(rb, procs[i]);
+    else
+      saws_shrb_getmem(rb, SHMEM_CTX_DEFAULT, &sv[i], &rb->steal_val, sizeof(uint64_t), procs[i], 0);
+  }
+  shmem_quiet();
+
+  for (int i = 0; i < n; i++) {
+    sizes[i] = 0;
+    if (saws_get_stealval(sv[i], &asteals, &itasks, &tail) < SAWS_MAX_EPOCHS && saws_claim(rb, itasks, asteals, &claimed) > 0)
+      sizes[i] = itasks - claimed;
+    rb->targets[procs[i]] = (sizes[i] > 0) ? FullQueue : EmptyQueue;
+  }
+}
+
+
+static inline int saws_shrb_free_space(saws_shrb_t *rb) {
+  return rb->max_size - (saws_shrb_local_size(rb) + saws_shrb_public_size(rb));
 }
 
 
@@ -292,93 +605,121 @@ void saws_shrb_unlock(saws_shrb_t *rb, int proc) {
 
 /*==================== SPLIT MOVEMENT ====================*/
 
-int saws_shrb_reclaim_space(saws_shrb_t *rb) {
-  GTC_ENTRY();
-
-  int reclaimed = 0;
-  uint32_t sum = 0;
+/*
+ * Number of tasks in the completed prefix of an epoch, i.e. how far past its vtail the
+ * tail may move.
+ */
+static inline uint64_t saws_epoch_completed(saws_shrb_t *rb, saws_completion_t *epoch) {
+  uint64_t sum = 0;
 
-  TC_START_TIMER(rb->tc, reclaim);
-  if (!rb->completed[rb->last].done) {
-    for (int i = 0; i < rb->completed[rb->last].maxsteals; i++){
-      if (rb->completed[rb->last].status[i] == 0) { TC_STOP_TIMER(rb->tc, reclaim); GTC_EXIT(0);}
-      sum += rb->completed[rb->last].status[i];
-    }
-    // if so, update tail index accordingly.
-    if (sum == rb->completed[rb->last].itasks) {
-      rb->tail = rb->completed[rb->cur].vtail;
-      rb->completed[rb->last].done = 1;
+  if (rb->completion == SAWSCompletionScan) {
+    // find longest sequence of completed steals in this epoch
+    for (int i = 0; i < epoch->maxsteals && sum < epoch->itasks; i++) {
+      if (epoch->status[i].ntasks == 0)
+        break;
+      sum += epoch->status[i].ntasks;
     }
+    return sum;
   }
-  // find longest sequence of completed steals in current epoch
-  sum = 0;
-  for (int i = 0; i < rb->completed[rb->cur].maxsteals; i++) {
-    if (rb->completed[rb->cur].status[i] == 0)
-      break;
-    sum += rb->completed[rb->cur].status[i];
-  }
-  if (sum == rb->completed[rb->cur].itasks) {
-    rb->completed[rb->cur].done = 1;
+
+  if ((uint64_t)epoch->ncompleted == epoch->itasks)
+    return epoch->itasks;
+
+  // only walk past the watermark when something new has completed
+  if ((uint64_t)epoch->ncompleted != epoch->wsum) {
+    while (epoch->watermark < epoch->maxsteals && epoch->status[epoch->watermark].ntasks != 0)
+      epoch->wsum += epoch->status[epoch->watermark++].ntasks;
   }
+  return epoch->wsum;
+}
+
+
+
+/*
+ * Advance the tail across completed steals.  Epochs are retired in order, oldest first: the
+ * tail can only move into an epoch once every steal from the epochs before it has completed.
+ */
+static inline void saws_shrb_retire_epochs(saws_shrb_t *rb) {
+  saws_completion_t *epoch;
+  uint64_t sum;
+
+  for (;;) {
+    epoch = &rb->completed[rb->oldest];
 
-  // only advance tail if last epoch is complete
-  if (rb->completed[rb->last].done && (sum > 0)) {
-    rb->tail = (rb->completed[rb->cur].vtail + sum) % rb->max_size;
+    sum = saws_epoch_completed(rb, epoch);
+    if (sum > 0)
+      rb->tail = (epoch->vtail + sum) % rb->max_size;
+
+    if (sum != epoch->itasks)
+      break; // outstanding steals, younger epochs have to wait
+
+    epoch->done = 1;
+    if (rb->oldest == rb->cur)
+      break;
+    rb->oldest = (rb->oldest + 1) % SAWS_MAX_EPOCHS;
+    rb->stats->nreclaimed++;
   }
+}
+
+
+
+int saws_shrb_reclaim_space(saws_shrb_t *rb) {
+  GTC_ENTRY();
 
-  //assert(saws_shrb_shared_isempty(rb) || rb->completed[rb->cur].done != 1 || rb->completed[rb->last].done != 1);
-  rb->nreccalls++;
+  TC_START_TIMER(rb->tc, reclaim);
+  saws_shrb_retire_epochs(rb);
+  rb->stats->nreccalls++;
   TC_STOP_TIMER(rb->tc, reclaim);
-  GTC_EXIT(reclaimed);
+  GTC_EXIT(0);
 }
 
 
 
-void saws_shrb_ensure_space(saws_shrb_t *rb, int n) {
+/*
+ * Make room for n elements in the ring, reclaiming space from completed steals if needed.
+ * Returns 0 if there still isn't enough room, the caller spills instead.
+ */
+int saws_shrb_ensure_space(saws_shrb_t *rb, int n) {
   GTC_ENTRY();
-  // Ensure that there is enough free space in the queue.  If there isn't
-  // wait until others finish their deferred copies so we can reclaim space.
+  int room = 1;
+
   TC_START_TIMER(rb->tc, ensure);
-  if (rb->max_size - (saws_shrb_local_size(rb) + saws_shrb_public_size(rb)) < n) {
+  if (saws_shrb_free_space(rb) < n) {
     saws_shrb_reclaim_space(rb);
-    if (rb->max_size - saws_shrb_size(rb) < n) {
-      // Error: amount of reclaimable space is less than what we need.
-      // Try increasing the size of the queue.
-      printf("SAWS_SHRB: Error, not enough space in the queue to push %d elements\n", n);
-      saws_shrb_print(rb);
-      assert(0);
+    if (saws_shrb_free_space(rb) < n) {
+      gtc_lprintf(DBGSHRB, "not enough space in the queue for %d elements, spilling\n", n);
+      room = 0;
     }
   }
   TC_STOP_TIMER(rb->tc, ensure);
-  GTC_EXIT();
+  GTC_EXIT(room);
 }
 
 
 
 void saws_shrb_release(saws_shrb_t *rb) {
   GTC_ENTRY();
-  uint64_t  steal_val;
   uint64_t nshared;
 
+  // don't share a pipelined steal until all of it has landed
+  if (rb->pending.ntasks)
+    GTC_EXIT();
+
   TC_START_TIMER(rb->tc, release);
 
   if (saws_shrb_local_size(rb) > 0 && (saws_shrb_shared_size(rb) == 0)) {
     nshared  = rb->nlocal / 2 + rb->nlocal % 2;
+    if (nshared > saws_max_release(rb))
+      nshared = saws_max_release(rb);
     rb->nlocal  -= nshared;
     rb->split    = (rb->split + nshared) % rb->max_size;
 
     gtc_lprintf(DBGSHRB, "releasing %d task\tsplit: %d  tail: %d\n", nshared, rb->split, rb->tail);
 
-    // initialize epoch
-    rb->completed[rb->cur].itasks    = nshared;
-    rb->completed[rb->cur].maxsteals = saws_max_steals(nshared);
-    rb->completed[rb->cur].done      = 0;
-    rb->completed[rb->cur].vtail     = rb->tail;
-    memset(&rb->completed[rb->cur].status, 0, sizeof(rb->completed[rb->cur].status));
-
-    steal_val = saws_set_stealval(rb->cur, nshared, rb->tail);
-    shmem_atomic_set(&rb->steal_val, steal_val, rb->procid);
-    rb->nrelease++;
+    // shared portion was empty, so every older epoch has drained
+    rb->oldest = rb->cur;
+    saws_shrb_open_epoch(rb, nshared, rb->tail);
+    rb->stats->nrelease++;
   }
   assert (rb->tail >= 0 && rb->tail < rb->max_size);
   TC_STOP_TIMER(rb->tc, release);
@@ -388,28 +729,54 @@ void saws_shrb_release(saws_shrb_t *rb) {
 
 void saws_shrb_release_all(saws_shrb_t *rb) {
   GTC_ENTRY();
-  uint64_t steal_val;
-  int amount  = saws_shrb_local_size(rb);
-  rb->nlocal -= amount;
-  rb->split   = (rb->split + amount) % rb->max_size;
-
-  steal_val = saws_set_stealval(rb->cur, amount, rb->tail);
-  shmem_atomic_set(&rb->steal_val, steal_val, rb->procid);
-  rb->nrelease++;
+  uint64_t amount;
+
+  saws_shrb_settle(rb);
+  amount = saws_shrb_local_size(rb);
+
+  if (amount > 0 && saws_shrb_shared_size(rb) == 0) {
+    if (amount > saws_max_release(rb))
+      amount = saws_max_release(rb);
+    rb->nlocal -= amount;
+    rb->split   = (rb->split + amount) % rb->max_size;
+
+    rb->oldest = rb->cur;
+    saws_shrb_open_epoch(rb, amount, rb->tail);
+    rb->stats->nrelease++;
+  }
   GTC_EXIT();
 }
 
 
 void saws_shrb_reacquire(saws_shrb_t *rb) {
   GTC_ENTRY();
-  uint64_t steal_val, asteals, itasks, amount;
-  uint64_t sum;
+  uint64_t steal_val, asteals, itasks, amount, tasks_left, stolen;
   int64_t vtail;
-  int tasks_left, stolen, astealcount, completedindex;
+  int next, waited;
 
   if ((saws_shrb_shared_size(rb) <= rb->nlocal) || rb->nlocal != 0)
     return;
 
+  // reacquiring opens a new epoch, make sure there's a free completion array for it.
+  // if every epoch in the ring still has outstanding steals, leave the shared portion
+  // alone and try again later rather than waiting on the stragglers.
+  TC_START_TIMER(rb->tc, reacqdefer);
+  saws_shrb_retire_epochs(rb);
+  next = (rb->cur + 1) % SAWS_MAX_EPOCHS;
+  if (next == rb->oldest) {
+    rb->stats->ndeferred++;
+    TC_STOP_TIMER(rb->tc, reacqdefer);
+    return;
+  }
+
+  // older epochs with outstanding steals used to be waited out right here,
+  // reacqwait times the reacquires that now go ahead without them
+  waited = rb->oldest != rb->cur;
+  if (waited) {
+    rb->stats->nwaited++;
+    TC_START_TIMER(rb->tc, reacqwait);
+  }
+
   TC_START_TIMER(rb->tc, reacquire);
 
   // disable steals and determine shared queue state
@@ -418,30 +785,9 @@ void saws_shrb_reacquire(saws_shrb_t *rb) {
   gtc_lprintf(DBGSHRB, "steals disabled : tail %d split: %d itasks: %d asteals: %d : shared size: %d nlocal: %d\n",
       rb->tail, rb->split, itasks, asteals, saws_shrb_shared_size(rb), rb->nlocal);
 
-  // assert that all steals from the last epoch have completed.
-  if (!rb->completed[rb->last].done) {
-retry:
-    sum = 0;
-    for (int i = 0; i < rb->completed[rb->last].maxsteals; i++) {
-      sum += rb->completed[rb->last].status[i];
-    }
-    if (sum != rb->completed[rb->last].itasks) {
-      goto retry;
-      gtc_dprintf("incomplete tasks over multiple epochs -- dying now\n");
-      exit(1);
-    }
-  }
-
   // determine the number of unclaimed tasks available in queue
-  astealcount = asteals;
-  tasks_left = itasks;
-
-  for (stolen = 0, tasks_left = itasks; astealcount > 0; astealcount--) {
-    tasks_left  = (tasks_left != 1) ? tasks_left >> 1 : 1; // # of stolen tasks for this steal
-    stolen += tasks_left;                                  // add to total amount stolen
-    tasks_left  = itasks - stolen;
-  }
-
+  stolen     = (asteals < (uint64_t)rb->completed[rb->cur].maxsteals) ? (uint64_t)rb->completed[rb->cur].offset[asteals] : itasks;
+  tasks_left = itasks - stolen;
 
   amount = (tasks_left == 1) ? 1 : tasks_left / 2 + tasks_left % 2;
 
@@ -454,47 +800,32 @@ retry:
     if (rb->split < 0)
       rb->split += rb->max_size;
 
-    // switch epochs
-    rb->cur  = (rb->cur + 1)  % SAWS_MAX_EPOCHS;
-    rb->last = (rb->last + 1) % SAWS_MAX_EPOCHS;
-    // reset current epoch
-    memset(&rb->completed[rb->cur], 0, sizeof(rb->completed[rb->cur]));
-
+    // close the current epoch at what was actually claimed, outstanding steals
+    // will be retired by saws_shrb_reclaim_space()
+    rb->completed[rb->cur].itasks = stolen;
+    vtail = (rb->completed[rb->cur].vtail + stolen) % rb->max_size;
 
-    // update tail wrt completed steals
-    completedindex = rb->completed[rb->last].vtail;
-    for (int i = 0; i < rb->completed[rb->last].maxsteals; i++) {
-      //gtc_lprintf(DBGSHRB, "c[%d] = %d ", i, rb->completed[rb->last].status[i]);
-      if (rb->completed[rb->last].status[i] == 0)
-        break;
-      completedindex += rb->completed[rb->last].status[i];
-    }
-    if (completedindex > rb->tail)
-      rb->tail = completedindex % rb->max_size;
-
-    // correct old epoch incase there's outstanding steals
-    rb->completed[rb->last].itasks = stolen;
-    rb->completed[rb->last].maxsteals = asteals;
-    // set current epoch
-    rb->completed[rb->cur].itasks = tasks_left - amount;
-    rb->completed[rb->cur].maxsteals = saws_max_steals(tasks_left - amount);
+    // open the next epoch with whatever is left in the shared portion
+    rb->cur = next;
+    saws_shrb_open_epoch(rb, tasks_left - amount, vtail);
     gtc_lprintf(DBGSHRB, "tail: %d split: %d itasks: %d computed: %d\n", rb->tail,
         rb->split, rb->completed[rb->cur].itasks, rb->split - rb->completed[rb->cur].itasks);
-    rb->completed[rb->cur].done = 0;
 
-    rb->completed[rb->cur].vtail = (rb->completed[rb->last].vtail + rb->completed[rb->last].itasks) % rb->max_size;
+    // update tail wrt completed steals
+    saws_shrb_retire_epochs(rb);
 
-    steal_val = saws_set_stealval(rb->cur, tasks_left - amount, rb->completed[rb->cur].vtail);
     gtc_lprintf(DBGSHRB, "reacquire: local size: %d shared size: %d\n", saws_shrb_local_size(rb), saws_shrb_shared_size(rb));
+    rb->stats->nreacquire++;
 
   } else {
-    gtc_lprintf(DBGSHRB, "reacquire found no tasks\n", amount, tasks_left);
-    //assert(rb->cur < SAWS_MAX_EPOCHS);
-    steal_val = saws_set_stealval(rb->cur, 0, rb->tail);
+    // everything has been claimed, re-enable the exhausted epoch as it was
+    gtc_lprintf(DBGSHRB, "reacquire found no tasks\n");
+    saws_stealval_set(rb, steal_val);
   }
 
-  shmem_atomic_set(&rb->steal_val, steal_val, rb->procid);
   TC_STOP_TIMER(rb->tc, reacquire);
+  if (waited)
+    TC_STOP_TIMER(rb->tc, reacqwait);
   GTC_EXIT();
 }
 
@@ -502,32 +833,133 @@ retry:
 /*==================== PUSH OPERATIONS ====================*/
 
 
-static inline void saws_shrb_push_n_head_impl(saws_shrb_t *rb, int proc, void *e, int n, int size) {
-  int head, old_head;
+/*
+ * varlen: place a record of len bytes in slot idx at the byte head and return its address.
+ * Slot accounting guarantees the byte ring has room, every record is at most one slot.
+ */
+static inline u_int8_t *saws_shrb_varlen_place(saws_shrb_t *rb, int64_t idx, int len) {
+  saws_slot_t *slot = saws_shrb_slot_addr(rb, idx);
+
+  slot->off  = rb->bhead;
+  slot->len  = len;
+  rb->bhead += SAWS_VARLEN_ALIGN(len);
+  if (rb->bhead >= rb->bcap)
+    rb->bhead = 0; // the record may run into the slack, the next one starts over
+  return rb->q + slot->off;
+}
 
-  assert(size == rb->elem_size || n == 1);  // n > 1 ==> size == rb->elem_size
-  assert(proc == rb->procid);
-  TC_START_TIMER(rb->tc, pushhead);
 
-  // Make sure there is enough space for n elements
-  saws_shrb_ensure_space(rb, n);
 
-  // Proceed with the push
+/*
+ * Copy n elements onto the head of the ring, the caller has made sure they fit.
+ */
+static inline void saws_shrb_ring_push(saws_shrb_t *rb, void *e, int n, int size) {
+  int head, old_head;
+
   old_head    = saws_shrb_head(rb);
   rb->nlocal += n;
+
+  if (rb->varlen) {
+    for (int i = 0; i < n; i++) {
+      u_int8_t *ei = saws_shrb_buff_elem_addr(rb, e, i);
+      int len = rb->elem_len ? rb->elem_len(ei) : size;
+
+      memcpy(saws_shrb_varlen_place(rb, (old_head + 1 + i) % rb->max_size, len), ei, len);
+    }
+    return;
+  }
+
   head        = saws_shrb_head(rb);
 
   if (head > old_head || old_head == rb->max_size - 1) {
-    memcpy(saws_shrb_elem_addr(rb, proc, (old_head+1)%rb->max_size), e, n*size);
+    memcpy(saws_shrb_elem_addr(rb, rb->procid, (old_head+1)%rb->max_size), e, n*size);
   }
 
   // This push wraps around, break it into two parts
   else {
     int part_size = rb->max_size - 1 - old_head;
 
-    memcpy(saws_shrb_elem_addr(rb, proc, old_head+1), e, part_size*size);
-    memcpy(saws_shrb_elem_addr(rb, proc, 0), saws_shrb_buff_elem_addr(rb, e, part_size), (n - part_size)*size);
+    memcpy(saws_shrb_elem_addr(rb, rb->procid, old_head+1), e, part_size*size);
+    memcpy(saws_shrb_elem_addr(rb, rb->procid, 0), saws_shrb_buff_elem_addr(rb, e, part_size), (n - part_size)*size);
+  }
+}
+
+
+
+/*
+ * Reserve n elements on top of the spill, growing it as needed.  The spill is a private
+ * stack that sits logically above the local head: it takes pushes while the ring is full,
+ * pop_head drains it first and saws_shrb_refill() moves its oldest elements back into the
+ * ring as space frees up, so the queue can be sized for the common case.
+ */
+static void *saws_shrb_spill_reserve(saws_shrb_t *rb, int n) {
+  void *e;
+
+  if (rb->nspill + n > rb->spill_max) {
+    int max = rb->spill_max ? rb->spill_max : 64;
+
+    while (max < rb->nspill + n)
+      max *= 2;
+    rb->spill = realloc(rb->spill, (size_t)max * rb->elem_size);
+    if (!rb->spill) {
+      gtc_eprintf(DBGERR, "saws_shrb: unable to grow the spill to %d elements\n", max);
+      exit(1);
+    }
+    rb->spill_max = max;
+  }
+
+  e = saws_shrb_buff_elem_addr(rb, rb->spill, rb->nspill);
+  rb->nspill   += n;
+  rb->stats->nspilled += n;
+  if (rb->nspill > rb->spill_hwm)
+    rb->spill_hwm = rb->nspill;
+  return e;
+}
+
+
+
+/*
+ * Move as much of the spill as fits back into the ring, oldest first so that the
+ * ring followed by the spill stays in push order.  Returns the number of elements moved.
+ */
+int saws_shrb_refill(saws_shrb_t *rb) {
+  GTC_ENTRY();
+  int n;
+
+  if (rb->nspill == 0)
+    GTC_EXIT(0);
+
+  saws_shrb_settle(rb);
+  if (saws_shrb_free_space(rb) < rb->nspill)
+    saws_shrb_reclaim_space(rb);
+
+  n = saws_shrb_free_space(rb);
+  if (n > rb->nspill)
+    n = rb->nspill;
+
+  if (n > 0) {
+    saws_shrb_ring_push(rb, rb->spill, n, rb->elem_size);
+    rb->nspill -= n;
+    memmove(rb->spill, saws_shrb_buff_elem_addr(rb, rb->spill, n), (size_t)rb->nspill * rb->elem_size);
   }
+  GTC_EXIT(n);
+}
+
+
+
+static inline void saws_shrb_push_n_head_impl(saws_shrb_t *rb, int proc, void *e, int n, int size) {
+  assert(size == rb->elem_size || n == 1);  // n > 1 ==> size == rb->elem_size
+  assert(proc == rb->procid);
+  TC_START_TIMER(rb->tc, pushhead);
+
+  saws_shrb_settle(rb);
+
+  // anything in the spill is newer than the ring, keep spilling until it's been refilled
+  if (rb->nspill > 0 || !saws_shrb_ensure_space(rb, n))
+    memcpy(saws_shrb_spill_reserve(rb, n), e, n*size);
+  else
+    saws_shrb_ring_push(rb, e, n, size);
+
   TC_STOP_TIMER(rb->tc, pushhead);
 }
 
@@ -541,13 +973,24 @@ void saws_shrb_push_head(saws_shrb_t *rb, int proc, void *e, int size) {
   assert(size <= rb->elem_size);
   assert(proc == rb->procid);
 
-  if ((cc++ % rb->reclaimfreq) == 0)
+  saws_shrb_settle(rb);
+
+  // ensure calls are damped, but never push into a full ring
+  if (rb->nspill == 0 && ((cc++ % rb->reclaimfreq) == 0 || saws_shrb_free_space(rb) < 1))
     saws_shrb_ensure_space(rb, 1);
 
+  if (rb->nspill > 0 || saws_shrb_free_space(rb) < 1) {
+    memcpy(saws_shrb_spill_reserve(rb, 1), e, size);
+    GTC_EXIT();
+  }
+
   old_head    = saws_shrb_head(rb);
   rb->nlocal += 1;
 
-  memcpy(saws_shrb_elem_addr(rb, proc, (old_head+1)%rb->max_size), e, size);
+  if (rb->varlen)
+    memcpy(saws_shrb_varlen_place(rb, (old_head+1)%rb->max_size, size), e, size);
+  else
+    memcpy(saws_shrb_elem_addr(rb, proc, (old_head+1)%rb->max_size), e, size);
   GTC_EXIT();
 }
 
@@ -564,11 +1007,18 @@ void saws_shrb_push_n_head(void *b, int proc, void *e, int n) {
 
 void *saws_shrb_alloc_head(saws_shrb_t *rb) {
   GTC_ENTRY();
+  saws_shrb_settle(rb);
+
   // Make sure there is enough space for 1 element
-  saws_shrb_ensure_space(rb, 1);
+  if (rb->nspill > 0 || !saws_shrb_ensure_space(rb, 1))
+    GTC_EXIT(saws_shrb_spill_reserve(rb, 1));
 
   rb->nlocal += 1;
 
+  // the caller fills the element in later, so it gets a whole slot
+  if (rb->varlen)
+    GTC_EXIT(saws_shrb_varlen_place(rb, saws_shrb_head(rb), rb->elem_size));
+
   GTC_EXIT(saws_shrb_elem_addr(rb, rb->procid, saws_shrb_head(rb)));
 }
 
@@ -583,15 +1033,36 @@ int saws_shrb_pop_head(void *b, int proc, void *buf) {
   int   old_head;
   int   buf_valid = 0;
 
+  // spilled elements are the newest
+  if (rb->nspill > 0) {
+    rb->nspill--;
+    memcpy(buf, saws_shrb_buff_elem_addr(rb, rb->spill, rb->nspill), rb->elem_size);
+    GTC_EXIT(1);
+  }
 
   // If we are out of local work, try to reacquire
   if (saws_shrb_local_isempty(rb))
     saws_shrb_reacquire(rb);
 
   if (saws_shrb_local_size(rb) > 0) {
+    // the top of a pipelined steal has arrived, the rest of it may still be in flight
+    if (rb->pending.ntasks) {
+      if (rb->pending.nready > 0)
+        rb->pending.nready--;
+      else
+        saws_shrb_steal_finish(rb);
+    }
+
     old_head = saws_shrb_head(rb);
 
-    memcpy(buf, saws_shrb_elem_addr(rb, proc, old_head), rb->elem_size);
+    if (rb->varlen) {
+      saws_slot_t *slot = saws_shrb_slot_addr(rb, old_head);
+
+      memcpy(buf, rb->q + slot->off, slot->len);
+      rb->bhead = slot->off; // the head record is always the last one in the byte ring
+    } else {
+      memcpy(buf, saws_shrb_elem_addr(rb, proc, old_head), rb->elem_size);
+    }
     rb->nlocal--;
     buf_valid = 1;
   }
@@ -602,33 +1073,179 @@ int saws_shrb_pop_head(void *b, int proc, void *buf) {
 
 int saws_shrb_pop_tail(saws_shrb_t *rb, int proc, void *buf) {
   GTC_ENTRY();
-  GTC_EXIT(saws_shrb_pop_n_tail(rb, proc, 1, buf, STEAL_CHUNK));
+  GTC_EXIT(saws_shrb_pop_n_tail(rb, proc, 1, buf, STEAL_HALF));
 }
 
+/*
+ * Non-blocking fetch of count elements starting at index start of proc's queue into e,
+ * splitting the transfer when the block wraps around the end of the queue.
+ */
+static inline void saws_shrb_get_block(saws_shrb_t *rb, shmem_ctx_t ctx, void *e, int proc, int64_t start, int count) {
+  int part_size = rb->max_size - start;
+
+  // varlen: e is a fixed-stride buffer, fetch each record described by rb->vslot into its slot
+  if (rb->varlen) {
+    for (int i = 0; i < count; i++)
+      saws_shrb_getmem(rb, ctx, saws_shrb_buff_elem_addr(rb, e, i), rb->q + rb->vslot[i].off, rb->vslot[i].len, proc, 0);
+    return;
+  }
+
+  if (count <= part_size) {
+    saws_shrb_getmem(rb, ctx, e, saws_shrb_elem_addr(rb, proc, start), (size_t)count * rb->elem_size, proc, 0);
+  } else {
+    saws_shrb_getmem(rb, ctx, e, saws_shrb_elem_addr(rb, proc, start), (size_t)part_size * rb->elem_size, proc, 0);
+    saws_shrb_getmem(rb, ctx, saws_shrb_buff_elem_addr(rb, e, part_size), saws_shrb_elem_addr(rb, proc, 0),
+        (size_t)(count - part_size) * rb->elem_size, proc, 0);
+  }
+}
+
+
+
+/*
+ * Non-blocking fetch of count elements starting at index src of proc's queue into our own
+ * queue starting at index dst, splitting the transfer wherever either block wraps.
+ */
+static inline void saws_shrb_get_ring(saws_shrb_t *rb, shmem_ctx_t ctx, int64_t dst, int proc, int64_t src, int count) {
+  while (count > 0) {
+    int part_size = count;
+
+    if (part_size > rb->max_size - src)
+      part_size = rb->max_size - src;
+    if (part_size > rb->max_size - dst)
+      part_size = rb->max_size - dst;
+
+    saws_shrb_getmem(rb, ctx, saws_shrb_elem_addr(rb, rb->procid, dst), saws_shrb_elem_addr(rb, proc, src),
+        (size_t)part_size * rb->elem_size, proc, 0);
+
+    count -= part_size;
+    src    = (src + part_size) % rb->max_size;
+    dst    = (dst + part_size) % rb->max_size;
+  }
+}
+
+
+
+/*
+ * varlen: blocking fetch of the slot entries of count elements starting at index src of proc's
+ * queue into rb->vslot.
+ */
+static inline void saws_shrb_get_slots(saws_shrb_t *rb, shmem_ctx_t ctx, int proc, int64_t src, int count) {
+  int part_size = rb->max_size - src;
+
+  if (count <= part_size) {
+    saws_shrb_getmem(rb, ctx, rb->vslot, saws_shrb_slot_addr(rb, src), (size_t)count * sizeof(saws_slot_t), proc, 1);
+  } else {
+    saws_shrb_getmem(rb, ctx, rb->vslot, saws_shrb_slot_addr(rb, src), (size_t)part_size * sizeof(saws_slot_t), proc, 1);
+    saws_shrb_getmem(rb, ctx, rb->vslot + part_size, saws_shrb_slot_addr(rb, 0),
+        (size_t)(count - part_size) * sizeof(saws_slot_t), proc, 1);
+  }
+}
+
+
+
+static inline void saws_shrb_get_run(saws_shrb_t *rb, shmem_ctx_t ctx, int64_t to, int proc, int64_t from, int64_t nbytes, int blocking) {
+  saws_shrb_getmem(rb, ctx, rb->q + to, rb->q + from, nbytes, proc, blocking);
+}
+
+
+
+/*
+ * varlen: lay out the count records described by rb->vslot[first..] at our byte head, in our
+ * own queue starting at index dst, and fetch them from proc.  Records that are contiguous in
+ * both byte rings go over in one transfer, so a steal takes a handful of gets at most.
+ */
+static inline void saws_shrb_get_records(saws_shrb_t *rb, shmem_ctx_t ctx, int64_t dst, int proc, int first, int count, int blocking) {
+  int64_t from = 0, to = 0, nbytes = 0;
+
+  for (int i = 0; i < count; i++) {
+    saws_slot_t *s = &rb->vslot[first + i];
+    int64_t len = SAWS_VARLEN_ALIGN(s->len);
+    int64_t off = saws_shrb_varlen_place(rb, (dst + i) % rb->max_size, s->len) - rb->q;
+
+    if (nbytes > 0 && s->off == from + nbytes && off == to + nbytes) {
+      nbytes += len;
+      continue;
+    }
+    if (nbytes > 0)
+      saws_shrb_get_run(rb, ctx, to, proc, from, nbytes, blocking);
+    from   = s->off;
+    to     = off;
+    nbytes = len;
+  }
+  if (nbytes > 0)
+    saws_shrb_get_run(rb, ctx, to, proc, from, nbytes, blocking);
+}
+
+
+
+/*
+ * Finish a pipelined steal: wait for the rest of the block to land in the local queue and
+ * notify the victim.  The completion is not waited on, it is flushed by the next steal or
+ * the next time this is called with nothing pending.
+ */
+void saws_shrb_steal_finish(saws_shrb_t *rb) {
+  GTC_ENTRY();
+  saws_pending_t *p = &rb->pending;
+  tc_timer_t done;
+
+  if (p->ntasks == 0) {
+    if (p->unflushed) {
+      shmem_ctx_quiet(rb->ctx);
+      p->unflushed = 0;
+    }
+    GTC_EXIT();
+  }
+
+  TC_INIT_ATIMER(done);
+  TC_START_ATIMER(done);
+
+  shmem_ctx_quiet(rb->ctx);
+
+  gtc_lprintf(DBGSHRB, "sending completion to epoch %d index %d\n", p->epoch, p->index);
+  saws_shrb_complete(rb, rb->ctx, p->epoch, p->index, p->ntasks, p->proc);
+  p->ntasks    = 0;
+  p->nready    = 0;
+  p->unflushed = 1;
+
+  TC_STOP_ATIMER(done);
+  TC_ADD_TIMER(rb->tc, stealdone, done);
+  GTC_EXIT();
+}
+
+
+
 /* Pop up to N elements off the tail of the queue, putting the result into the user-
  *  supplied buffer.
  *
  *  @param myrb  Pointer to the RB
  *  @param proc  Process to perform the pop on
- *  @param n     Requested/Max. number of elements to pop.
- *  @param e     Buffer to store result in.  Should be rb->elem_size*n bytes big and
- *               should also be allocated with saws_shrb_malloc().
- *  @param steal_vol Enumeration that selects between different schemes for determining
- *               the amount we steal.
+ *  @param n     Requested/Max. number of elements to pop.  Ignored, the volume is set
+ *               by the claim schedule of the target's current epoch.
+ *  @param e     Buffer to store result in.  Should be big enough for the largest claim
+ *               (chunk_size elements for STEAL_CHUNK, half the queue otherwise).  If NULL,
+ *               the tasks land directly on the head of myrb's local portion.
+ *  @param steal_vol Ignored, the claim schedule follows the collection's steal_method
+ *               so that owner and thieves agree on it.
  *  @param trylock Indicates whether to use trylock or lock.  Using trylock will result
  *               in a fail return value when trylock does not succeed.
  *
- *  @return      The number of tasks stolen or -1 on failure
+ *  @return      The number of tasks stolen or -1 on failure.  Pipelined steals into the
+ *               local queue return as soon as the task at the head has arrived, the rest
+ *               is finished by saws_shrb_steal_finish().
  */
 static inline int saws_shrb_pop_n_tail_impl(saws_shrb_t *myrb, int proc, int n, void *e, int steal_vol, int trylock) {
-  int valid, ntasks = 0, stolen = 0;
-  uint64_t steal_val, asteals, tasks_left, itasks, increment, maxsteals;
-  int64_t  rtail;
-  void *rptr = NULL;
-  increment = 1L << 40;
+  int valid, index, ntasks = 0;
+  uint64_t steal_val, asteals, itasks, increment;
+  int64_t  rtail, start, stolen = 0;
+  increment = 1UL << SAWS_ASTEALS_SHIFT;
   tc_timer_t gotwork;
+
+  // flush the last steal's completion, its slots may be about to move
+  saws_shrb_steal_finish(myrb);
+
   TC_INIT_ATIMER(gotwork);
   TC_START_ATIMER(gotwork);
+  myrb->stats->ngets++;
 
   //shmem_quiet();
   // if target is in empty mode
@@ -637,9 +1254,9 @@ static inline int saws_shrb_pop_n_tail_impl(saws_shrb_t *myrb, int proc, int n,
   //   claim work
   test:
    if (myrb->targets[proc] == FullQueue)
-   steal_val = shmem_atomic_fetch_add(&myrb->steal_val, increment, proc);
+   steal_val = saws_stealval_fetch_add(myrb, increment, proc);
   else
-   steal_val = shmem_atomic_fetch(&myrb->steal_val, proc);
+   steal_val = saws_stealval_fetch(myrb, proc);
 
 //  steal_val = shmem_atomic_fetch_add(&myrb->steal_val, increment, proc);
   valid = saws_get_stealval(steal_val, &asteals, &itasks, &rtail);
@@ -648,31 +1265,24 @@ static inline int saws_shrb_pop_n_tail_impl(saws_shrb_t *myrb, int proc, int n,
     gtc_lprintf(DBGSHRB, "remote queue invalid PE: %d : valid: %d\n", proc, valid);
     goto notfound;
   }
-  maxsteals = saws_max_steals(itasks);
+  // look up our claim in the epoch's schedule
+  index  = asteals;
+  if (myrb->tc->ldbal_cfg.steal_method == STEAL_WORK)
+    ntasks = saws_claim_work(myrb, proc, valid, asteals, rtail, itasks, &stolen);
+  else
+    ntasks = saws_claim(myrb, itasks, asteals, &stolen);
 
-  if (asteals >= maxsteals) {
+  if (ntasks == 0) {
     myrb->targets[proc] = EmptyQueue;
     goto notfound;
   } else if (myrb->targets[proc] == EmptyQueue) {
     myrb->targets[proc] = FullQueue;
+    ntasks = 0;
     goto test;
   }
 
-  gtc_lprintf(DBGSHRB, "Calculating steal volume, maxsteals %"PRIu64", asteals %"PRIu64" itasks %"PRIu64"\n",
-      maxsteals, asteals, itasks);
-
-  // calculate number of tasks already stolen
-  int index = asteals;
-  for (stolen = 0, tasks_left = itasks; asteals > 0; asteals--) {
-    tasks_left  = (tasks_left != 1) ? tasks_left >> 1 : 1; // # of stolen tasks for this steal
-    stolen += tasks_left;                          // add to total amount stolen
-    tasks_left  = itasks - stolen;
-  }
-
-  // calculate steal volume for our attempt
-  ntasks = (tasks_left != 1) ? tasks_left >> 1 : 1;
-  if(ntasks <= 0)
-    goto notfound; // no work
+  gtc_lprintf(DBGSHRB, "Claimed steal %"PRIu64" of %"PRIu64" tasks: offset %"PRId64" volume %d\n",
+      asteals, itasks, stolen, ntasks);
 
   // we have to handle dispersion and search timers here
   // because our discovery and steal is all done here
@@ -683,39 +1293,70 @@ static inline int saws_shrb_pop_n_tail_impl(saws_shrb_t *myrb, int proc, int n,
 
   gtc_lprintf(DBGGET, "attempting from (%d), starting at index %d\n", ntasks, proc, rtail + stolen);
 
-  // determine base address of tasks to steal
-  rptr = &myrb->q[0] + ((rtail + stolen) * myrb->elem_size);
-
-  // check to see if the task block wraps around the end of the queue
-  if (rtail + stolen + ntasks < myrb->max_size) {
-    // No wrap
-    shmem_getmem_nbi(e, rptr, ntasks * myrb->elem_size, proc);
+  start = (rtail + stolen) % myrb->max_size;
+  myrb->stats->nsteals++;
+  if (myrb->peers[proc]) {
+    myrb->stats->nlocalsteals++;
+    atomic_thread_fence(memory_order_acquire); // read the tasks only after the claim
+  }
 
+  // varlen: the claimed slot entries say where the records are and how much to move
+  if (myrb->varlen) {
+    saws_shrb_get_slots(myrb, myrb->ctx, proc, start, ntasks);
+    myrb->stats->nxfer += ntasks * sizeof(saws_slot_t);
+    for (int i = 0; i < ntasks; i++)
+      myrb->stats->nxfer += SAWS_VARLEN_ALIGN(myrb->vslot[i].len);
   } else {
-    // If the steal wraps around the end of the queue it requires two communications.
-    // In the case that the previous steal was a wrapping steal and the queue has not been reset
-    // only one steal is needed with a recalculated start index.
-
-    // calculate how many tasks from thosealready stolen to the end of the queue
-    int part_size = myrb->max_size - (rtail + stolen);
-    gtc_lprintf(DBGSHRB, "nmax_size: %d  stolen: %d  part size: %d\n", myrb->max_size, rtail + stolen, part_size);
-
-    if (part_size > 0) {
-      shmem_getmem_nbi(saws_shrb_buff_elem_addr(myrb, e, 0), rptr, part_size * myrb->elem_size, proc);
-      // steal from beginning of queue the remaining tasks
-      shmem_getmem_nbi(saws_shrb_buff_elem_addr(myrb, e, part_size),
-          saws_shrb_elem_addr(myrb, proc, 0),
-          (ntasks - part_size) * myrb->elem_size, proc);
+    myrb->stats->nxfer += ntasks * myrb->elem_size;
+  }
+
+  // no room above our head, land the block in the spill instead
+  if (e == NULL && !saws_shrb_ensure_space(myrb, ntasks))
+    e = saws_shrb_spill_reserve(myrb, ntasks);
+
+  if (e == NULL) {
+    int64_t dst;
+
+    // land the block right above our head
+    dst = (saws_shrb_head(myrb) + 1) % myrb->max_size;
+
+    // nothing to overlap when the copy is a memcpy
+    if (myrb->pipeline && ntasks > 1 && !myrb->peers[proc]) {
+      // the last task becomes our head, pull it with a blocking get so the caller can
+      // start on it while the rest is still in flight on the steal context.
+      if (myrb->varlen) {
+        saws_shrb_get_records(myrb, myrb->ctx, dst, proc, 0, ntasks - 1, 0);
+        saws_shrb_get_records(myrb, SHMEM_CTX_DEFAULT, (dst + ntasks - 1) % myrb->max_size, proc, ntasks - 1, 1, 1);
+      } else {
+        saws_shrb_get_ring(myrb, myrb->ctx, dst, proc, start, ntasks - 1);
+        shmem_getmem(saws_shrb_elem_addr(myrb, myrb->procid, (dst + ntasks - 1) % myrb->max_size),
+            saws_shrb_elem_addr(myrb, proc, (start + ntasks - 1) % myrb->max_size), myrb->elem_size, proc);
+      }
+
+      myrb->pending.proc   = proc;
+      myrb->pending.epoch  = valid;
+      myrb->pending.index  = index;
+      myrb->pending.ntasks = ntasks;
+      myrb->pending.nready = 1;
+    } else if (myrb->varlen) {
+      saws_shrb_get_records(myrb, SHMEM_CTX_DEFAULT, dst, proc, 0, ntasks, 0);
     } else {
-      // the previous steal on this process was also a wrapping steal
-      void * new_start = &myrb->q[0] + (abs(part_size) * myrb->elem_size);
-      shmem_getmem_nbi(e, new_start, ntasks * myrb->elem_size, proc);
+      saws_shrb_get_ring(myrb, SHMEM_CTX_DEFAULT, dst, proc, start, ntasks);
     }
+    myrb->nlocal += ntasks;
+
+  } else {
+    saws_shrb_get_block(myrb, SHMEM_CTX_DEFAULT, e, proc, start, ntasks);
   }
 
-  gtc_lprintf(DBGSHRB, "sending completion to epoch %d index %d\n", valid, index);
-  shmem_quiet(); // this is required to wait for the non-blocking shmem_getmem_nbi's
-  shmem_atomic_add(&myrb->completed[valid].status[index], ntasks, proc);
+  if (!myrb->pending.ntasks) {
+    gtc_lprintf(DBGSHRB, "sending completion to epoch %d index %d\n", valid, index);
+    if (myrb->peers[proc])
+      atomic_thread_fence(memory_order_release); // finish our loads before the victim can reuse the slots
+    else
+      shmem_quiet(); // this is required to wait for the non-blocking shmem_getmem_nbi's
+    saws_shrb_complete(myrb, SHMEM_CTX_DEFAULT, valid, index, ntasks, proc);
+  }
 
   TC_STOP_ATIMER(gotwork);
   TC_ADD_TIMER(myrb->tc, poptail, gotwork);
@@ -737,3 +1378,17 @@ int saws_shrb_try_pop_n_tail(void *b, int proc, int n, void *e, int steal_vol) {
   saws_shrb_t *myrb = (saws_shrb_t *)b;
   GTC_EXIT(saws_shrb_pop_n_tail_impl(myrb, proc, n, e, steal_vol, 1));
 }
+
+
+int saws_shrb_steal_n_tail(void *b, int proc, int n, int steal_vol) {
+  GTC_ENTRY();
+  saws_shrb_t *myrb = (saws_shrb_t *)b;
+  GTC_EXIT(saws_shrb_pop_n_tail_impl(myrb, proc, n, NULL, steal_vol, 0));
+}
+
+
+int saws_shrb_try_steal_n_tail(void *b, int proc, int n, int steal_vol) {
+  GTC_ENTRY();
+  saws_shrb_t *myrb = (saws_shrb_t *)b;
+  GTC_EXIT(saws_shrb_pop_n_tail_impl(myrb, proc, n, NULL, steal_vol, 1));
+}
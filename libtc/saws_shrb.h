@@ -7,8 +7,74 @@
 #include <mutex.h>
 #include <tc.h>
 
-#define SAWS_MAX_EPOCHS           2L
-#define SAWS_MAX_STEALS_PER_EPOCH 22
+/*
+ * Completion arrays form a ring of SAWS_MAX_EPOCHS epochs.  The owner opens a new epoch on
+ * every reacquire and retires old ones lazily in saws_shrb_reclaim_space(), so a slow thief only
+ * stalls reacquire when all epochs in the ring still have outstanding steals.
+ */
+#ifndef SAWS_MAX_EPOCHS
+#define SAWS_MAX_EPOCHS           4L
+#endif
+
+/*
+ * steal_val claim word layout (least to most significant):
+ *
+ *   | tail : SAWS_INDEX_BITS | itasks : SAWS_INDEX_BITS | epoch : SAWS_EPOCH_BITS | asteals : remaining bits |
+ *
+ * Thieves claim work with a single fetch-add on asteals, so it must stay in the topmost
+ * field.  SAWS_INDEX_BITS bounds both the queue size and the number of tasks in one release,
+ * it can be overridden at build time (e.g. -DSAWS_INDEX_BITS=24) at the cost of asteals bits.
+ */
+#ifndef SAWS_INDEX_BITS
+#define SAWS_INDEX_BITS           22
+#endif
+#define SAWS_EPOCH_BITS           3   // enough for SAWS_MAX_EPOCHS indices plus the disable bit
+#define SAWS_ASTEALS_BITS         (64 - 2*SAWS_INDEX_BITS - SAWS_EPOCH_BITS)
+
+/*
+ * Each epoch publishes a claim schedule: steal k of an epoch takes the tasks in
+ * [vtail + offset[k], vtail + offset[k+1]).  The schedule is a pure function of the number of
+ * released tasks and the collection's steal method, so thieves rebuild the entry they claimed
+ * locally from the fetch-add result and no extra communication is needed.  Chunked schedules
+ * are bounded by SAWS_MAX_STEALS_PER_EPOCH, releases are capped to fit.
+ */
+#ifndef SAWS_MAX_STEALS_PER_EPOCH
+#define SAWS_MAX_STEALS_PER_EPOCH 64
+#endif
+
+/*
+ * STEAL_WORK schedules follow the owner's task cost estimates, which thieves can't rebuild.
+ * The owner publishes each entry as one word that the thief fetches atomically after its claim:
+ *
+ *   | offset : SAWS_INDEX_BITS | vtail : SAWS_INDEX_BITS | ntasks : remaining bits |
+ *
+ * Entries past the end of the schedule are zero.  A thief whose claim fell past the end of an
+ * epoch that has been reopened since sees the new epoch's vtail and takes nothing.  Releases
+ * are capped so that any step fits in ntasks.
+ */
+#define SAWS_SCHED_VTAIL_SHIFT    (64 - 2*SAWS_INDEX_BITS)
+#define SAWS_SCHED_OFFSET_SHIFT   (64 - SAWS_INDEX_BITS)
+#define SAWS_SCHED_NTASKS_MASK    ((1UL << SAWS_SCHED_VTAIL_SHIFT) - 1)
+
+#define saws_sched_pack(O, V, N)  (((uint64_t)(O) << SAWS_SCHED_OFFSET_SHIFT) | ((uint64_t)(V) << SAWS_SCHED_VTAIL_SHIFT) | (uint64_t)(N))
+#define saws_sched_offset(S)      ((S) >> SAWS_SCHED_OFFSET_SHIFT)
+#define saws_sched_vtail(S)       (((S) >> SAWS_SCHED_VTAIL_SHIFT) & SAWS_INDEX_MASK)
+#define saws_sched_ntasks(S)      ((S) & SAWS_SCHED_NTASKS_MASK)
+
+#define SAWS_ITASKS_SHIFT         SAWS_INDEX_BITS
+#define SAWS_EPOCH_SHIFT          (2*SAWS_INDEX_BITS)
+#define SAWS_ASTEALS_SHIFT        (SAWS_EPOCH_SHIFT + SAWS_EPOCH_BITS)
+
+#define SAWS_INDEX_MASK           ((1UL << SAWS_INDEX_BITS) - 1)
+#define SAWS_EPOCH_MASK           ((1UL << SAWS_EPOCH_BITS) - 1)
+#define SAWS_ASTEALS_MASK         ((1UL << SAWS_ASTEALS_BITS) - 1)
+#define SAWS_EPOCH_DISABLED       (1UL << (SAWS_EPOCH_BITS - 1))  // or'd into epoch to disable steals
+#define SAWS_MAX_QUEUE_SIZE       ((int64_t)SAWS_INDEX_MASK)      // itasks must fit a full queue
+
+#define saws_stealval_tail(SV)    ((SV) & SAWS_INDEX_MASK)
+#define saws_stealval_itasks(SV)  (((SV) >> SAWS_ITASKS_SHIFT) & SAWS_INDEX_MASK)
+#define saws_stealval_epoch(SV)   (((SV) >> SAWS_EPOCH_SHIFT) & SAWS_EPOCH_MASK)
+#define saws_stealval_asteals(SV) (((SV) >> SAWS_ASTEALS_SHIFT) & SAWS_ASTEALS_MASK)
 
 typedef enum {
   SAWSPopTailTime,
@@ -23,8 +89,14 @@ typedef enum {
   SAWSPerEnsureTime,
   SAWSReacquireTime,
   SAWSPerReacquireTime,
+  SAWSReacqWaitTime,
+  SAWSPerReacqWaitTime,
+  SAWSReacqDeferTime,
+  SAWSPerReacqDeferTime,
   SAWSReleaseTime,
-  SAWSPerReleaseTime
+  SAWSPerReleaseTime,
+  SAWSPerStealTime,
+  SAWSPerStealDoneTime
 } gtc_sdc_gtimestats_e;
 
 
@@ -41,28 +113,124 @@ typedef enum {
   SAWSReclaimCalls,
   SAWSEnsureCalls,
   SAWSReacquireCalls,
-  SAWSReleaseCalls
+  SAWSReacquireStalls,
+  SAWSReacquireDeferred,
+  SAWSReleaseCalls,
+  SAWSSpilled,
+  SAWSSpillHWM,
+  SAWSLocalSteals
 } gtc_sdc_gcountstats_e;
 
+/*
+ * How the owner finds the completed prefix of an epoch:
+ *  - counter: thieves also bump a per-epoch completed-task counter.  The owner only walks the
+ *             status array past its watermark when the counter moved, so reclaim is O(1) when
+ *             nothing new completed and amortized O(1) per steal otherwise.
+ *  - scan:    the owner rescans status[] from the start of the epoch on every reclaim.
+ * Selected with GTC_SAWS_COMPLETION=counter|scan, all processes must agree.
+ */
+typedef enum {
+  SAWSCompletionCounter,
+  SAWSCompletionScan
+} saws_completion_e;
+
+/*
+ * Thieves add to their steal's status entry and to ncompleted, while the owner reads and resets
+ * the rest of the epoch.  Each remotely updated word sits on its own cache line so that
+ * concurrent thieves, and the owner's reclaim scan, never invalidate each other's lines.
+ */
+struct saws_status_s {
+  int      ntasks;                             // (remote) tasks in this steal once it completes, 0 before
+} GTC_CACHE_ALIGNED;
+typedef struct saws_status_s saws_status_t;
+
 struct saws_completion_s {
   uint64_t itasks;                             // initial number of available tasks
   int64_t  vtail;                              // initial tail for this steal epoch
+  uint64_t wsum;                               // tasks in the completed prefix [0, watermark)
+  int      watermark;                          // number of steals in the completed prefix
   int      done;                               // true if all outstanding steals are complete
   int      maxsteals;                          // maximum number of steal operations for itasks tasks
-  int      status[SAWS_MAX_STEALS_PER_EPOCH];  // ordered completion status for all steals in this epoch
+  int      offset[SAWS_MAX_STEALS_PER_EPOCH+1];// claim schedule, steal k starts offset[k] tasks past vtail
+  uint64_t sched[SAWS_MAX_STEALS_PER_EPOCH];   // (remote) STEAL_WORK: the schedule packed for thieves, see saws_sched_*()
+  int64_t  ncompleted GTC_CACHE_ALIGNED;       // (remote) tasks from completed steals, counter mode
+  saws_status_t status[SAWS_MAX_STEALS_PER_EPOCH]; // ordered completion status for all steals in this epoch
 };
 typedef struct saws_completion_s saws_completion_t;
 
 
+/*
+ * Pipelined steals land in the thief's own queue above its head, but only the topmost slot
+ * (the first one pop_head returns) is fetched with a blocking get.  The rest of the block is
+ * still in flight on the queue's steal context and is finished by saws_shrb_steal_finish()
+ * before anything else touches those slots.
+ */
+struct saws_pending_s {
+  int      proc;                               // victim
+  int      epoch;                              // victim's epoch index for the completion
+  int      index;                              // steal index within that epoch
+  int      ntasks;                             // number of tasks in the steal, 0 if none pending
+  int      nready;                             // slots at the head that have already arrived
+  int      unflushed;                          // completion sent but not yet quieted
+};
+typedef struct saws_pending_s saws_pending_t;
+
+
+/*
+ * Variable-length slots (GTC_QUEUE_VARLEN=1): q holds a byte ring of 8-byte aligned records
+ * followed by an index ring with one {offset, length} entry per queue slot.  Indices, epochs
+ * and claims work exactly as with fixed slots, but a steal fetches the claimed index entries
+ * first and then only the bytes those records use.  The byte ring is as large as the fixed
+ * slot array, plus one record of slack so a record never wraps.
+ */
+struct saws_slot_s {
+  int32_t  off;                                // byte offset of the record in the byte ring
+  int32_t  len;                                // record length in bytes
+};
+typedef struct saws_slot_s saws_slot_t;
+
+#define SAWS_VARLEN_ALIGN(X)      (((X) + 7) & ~7)
+
+
+/*
+ * Owner-private queue counters.  They live outside the symmetric queue header so that bumping
+ * them on every push and pop never touches memory that thieves access.
+ */
+struct saws_shrb_stats_s {
+  tc_counter_t      nwaited;   // How many times did reacquire find older epochs with outstanding steals
+  tc_counter_t      ndeferred; // How many times was reacquire deferred because the epoch ring was full
+  tc_counter_t      nreclaimed;// How many times did I reclaim space from the public portion of the queue
+  tc_counter_t      nreccalls; // How many times did I even try to reclaim
+  tc_counter_t      nrelease;  // Number of times work was released from local->public
+  tc_counter_t      nprogress; // Number of otimes we called the progress routine
+  tc_counter_t      nreacquire;// Number of times work was reacquired from public->local
+  tc_counter_t      ngets;     // Number of times we attempted a steal
+  tc_counter_t      nensure;   // Number of times we call reclaim space
+  tc_counter_t      nxfer;     // xferred bytes
+  tc_counter_t      nsteals;   // number of successful steals
+  tc_counter_t      nmeta;     // number of successful steals
+  tc_counter_t      nspilled;  // number of elements pushed into the spill
+  tc_counter_t      nlocalsteals; // successful steals from a victim mapped on this node
+};
+typedef struct saws_shrb_stats_s saws_shrb_stats_t;
+
+
+/*
+ * Header layout: thieves only ever touch steal_val and the completion ring, everything above
+ * steal_val is written by the owner alone and shares lines only with other owner state.
+ */
 struct saws_shrb_s {
 
   int64_t           tail;      // Index of tail element (between 0 and rb_size-1)
   int64_t           vtail;     // Index of public tail element
-  uint64_t          steal_val; // Concatenation of tail, isteals, and asteals
-  uint32_t         *targets;   // Holds the last known queue state for all other nodes 
   int64_t           split;     // index of split between local-only and local-shared elements
   int               nlocal;    // Number of elements in the local portion of the queue
   int               nshared;
+  int               cur;       // index of current completion array
+  int               oldest;    // index of oldest unretired completion array
+  uint32_t         *targets;   // Holds the last known queue state for all other nodes 
+  void            **peers;     // (private) each proc's queue mapped into our address space, NULL if off-node
+  int               local_atomics; // every queue is mapped, update steal_val/completions with CPU atomics
 
   synch_mutex_t     lock;      // lock for shared portion of this queue
   int               waiting;   // Am I currently waiting for transactions to complete?
@@ -72,26 +240,29 @@ struct saws_shrb_s {
   int               max_size;  // Max size in number of elements
   int               elem_size; // Size of an element in bytes 
   int               reclaimfreq;                        // reclaim dampening frequency
-  int               claimed[SAWS_MAX_STEALS_PER_EPOCH]; // # claimed task lookup table
-  saws_completion_t completed[SAWS_MAX_EPOCHS];         // completion arrays
-  int               cur;                                // index of current completion array
-  int               last;                               // index of last completion array
+  int               completion;                         // completion tracking mode (saws_completion_e)
+  int               pipeline;                           // pipelined steals (GTC_SAWS_PIPELINE)
+  shmem_ctx_t       ctx;                                // private context for steal traffic
+  saws_pending_t    pending;                            // pipelined steal still in flight
+
+  u_int8_t         *spill;     // (private) overflow stack above the local head, see saws_shrb_refill()
+  int               nspill;    // Number of elements in the spill
+  int               spill_max; // Allocated size of the spill in number of elements
+  int               spill_hwm; // Spill high-water mark
+
+  int               varlen;    // variable-length slots, see saws_slot_t
+  int64_t           bcap;      // varlen: byte ring capacity, the index ring follows the slack
+  int64_t           bhead;     // (private) varlen: next free offset in the byte ring
+  saws_slot_t      *vslot;     // (private) varlen: slot entries fetched from a victim
+  int             (*elem_len)(void *e); // varlen: length of an element being pushed, NULL for elem_size
 
   tc_t             *tc;        // task collection associated with queue (for stats)
+  saws_shrb_stats_t *stats;    // (private) queue counters
 
-  tc_counter_t      nwaited;   // How many times did I have to wait
-  tc_counter_t      nreclaimed;// How many times did I reclaim space from the public portion of the queue
-  tc_counter_t      nreccalls; // How many times did I even try to reclaim
-  tc_counter_t      nrelease;  // Number of times work was released from local->public
-  tc_counter_t      nprogress; // Number of otimes we called the progress routine
-  tc_counter_t      nreacquire;// Number of times work was reacquired from public->local
-  tc_counter_t      ngets;     // Number of times we attempted a steal
-  tc_counter_t      nensure;   // Number of times we call reclaim space
-  tc_counter_t      nxfer;     // xferred bytes
-  tc_counter_t      nsteals;   // number of successful steals
-  tc_counter_t      nmeta;     // number of successful steals
+  uint64_t          steal_val GTC_CACHE_ALIGNED;        // (remote) concatenation of tail, itasks, epoch, and asteals
+  saws_completion_t completed[SAWS_MAX_EPOCHS];         // (remote) completion array ring
 
-  u_int8_t          q[0];      // (shared)  ring buffer data.  This will be allocated
+  u_int8_t          q[0] GTC_CACHE_ALIGNED; // (shared)  ring buffer data.  This will be allocated
   // contiguous with the rb_s so allocating an rb_s will
   // require "sizeof(struct rb_s) + elem_size*rb_size"
 };
@@ -117,6 +288,7 @@ void        saws_shrb_release(saws_shrb_t *rb);
 void        saws_shrb_release_all(saws_shrb_t *rb);
 void        saws_shrb_reacquire(saws_shrb_t *rb);
 int         saws_shrb_reclaim_space(saws_shrb_t *rb);
+int         saws_shrb_refill(saws_shrb_t *rb);
 
 void        saws_shrb_push_head(saws_shrb_t *rb, int proc, void *e, int size);
 void        saws_shrb_push_n_head(void *b, int proc, void *e, int n);
@@ -126,15 +298,20 @@ int         saws_shrb_pop_head(void *b, int proc, void *buf);
 int         saws_shrb_pop_tail(saws_shrb_t *rb, int proc, void *buf);
 int         saws_shrb_pop_n_tail(void *b, int proc, int n, void *buf, int steal_vol);
 int         saws_shrb_try_pop_n_tail(void *b, int proc, int n, void *buf, int steal_vol);
+int         saws_shrb_steal_n_tail(void *b, int proc, int n, int steal_vol);
+int         saws_shrb_try_steal_n_tail(void *b, int proc, int n, int steal_vol);
+void        saws_shrb_steal_finish(saws_shrb_t *rb);
 
 int         saws_shrb_size(void *b);
+void        saws_shrb_probe_n(void *b, int *procs, int n, int *sizes);
 int         saws_shrb_full(saws_shrb_t *rb);
 int         saws_shrb_empty(saws_shrb_t *rb);
 
 void        saws_shrb_print(saws_shrb_t *rb);
 
-#define saws_shrb_elem_addr(MYRB, PROC, IDX) ((MYRB->q) + (IDX)*(MYRB)->elem_size)
-#define saws_shrb_buff_elem_addr(RB, E, IDX) ((u_int8_t*)(E) + (IDX)*(RB)->elem_size)
+#define saws_shrb_elem_addr(MYRB, PROC, IDX) ((MYRB->q) + (size_t)(IDX)*(MYRB)->elem_size)
+#define saws_shrb_buff_elem_addr(RB, E, IDX) ((u_int8_t*)(E) + (size_t)(IDX)*(RB)->elem_size)
+#define saws_shrb_slot_addr(RB, IDX) ((saws_slot_t *)((RB)->q + (RB)->bcap + SAWS_VARLEN_ALIGN((RB)->elem_size)) + (IDX))
 
 // ARMCI allocated buffers should be faster/pinned
 #define saws_shrb_malloc gtc_shmem_calloc
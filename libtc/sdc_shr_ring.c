@@ -9,6 +9,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <stdatomic.h>
 
 #include <mutex.h>
 
@@ -37,6 +38,12 @@
  * Itail - Tells us the collective progress of all transactions in the reserved portion.
  *         When Itail == tail we can reclaim the reserved space.
  *
+ * Tail and split are published together in the packed meta word, which is all a thief needs
+ * to see how much work a victim is sharing.  By default thieves serialize on the queue lock to
+ * advance the tail.  In lock-free mode a thief instead reserves its tasks with one CAS on meta;
+ * the data is only fetched after the CAS succeeds, so a word that went A->B->A in between still
+ * describes the elements being reserved and no separate epoch is needed.
+ *
  * The ring buffer can in in several states:
  *
  * 1. Empty.  In this case we have nlocal == 0, tail == split, and vtail == itail == tail
@@ -62,6 +69,68 @@
  */
 
 
+/*
+ * Node-local fast path: when proc's queue is mapped into our address space (shmem_ptr), steals
+ * copy tasks out with memcpy instead of RMA.  The meta and itail words are updated with CPU
+ * atomics only when every queue is mapped, otherwise off-node thieves' NIC atomics could race
+ * with them, so mixed jobs keep using shmem atomics for those.
+ */
+
+/* proc's copy of the symmetric address sym within its queue */
+static inline void *sdc_shrb_peer(sdc_shrb_t *rb, void *sym, int proc) {
+  return (u_int8_t *)rb->peers[proc] + ((u_int8_t *)sym - (u_int8_t *)rb);
+}
+
+static inline uint64_t sdc_shrb_meta_fetch(sdc_shrb_t *rb, int proc) {
+  if (rb->local_atomics)
+    return atomic_load((_Atomic uint64_t *)sdc_shrb_peer(rb, &rb->meta, proc));
+  return shmem_atomic_fetch(&rb->meta, proc);
+}
+
+static inline void sdc_shrb_meta_add(sdc_shrb_t *rb, uint64_t val, int proc) {
+  if (rb->local_atomics)
+    atomic_fetch_add((_Atomic uint64_t *)sdc_shrb_peer(rb, &rb->meta, proc), val);
+  else
+    shmem_atomic_add(&rb->meta, val, proc);
+}
+
+static inline uint64_t sdc_shrb_meta_cas(sdc_shrb_t *rb, uint64_t cond, uint64_t val, int proc) {
+  if (rb->local_atomics) {
+    atomic_compare_exchange_strong((_Atomic uint64_t *)sdc_shrb_peer(rb, &rb->meta, proc), &cond, val);
+    return cond;
+  }
+  return shmem_atomic_compare_swap(&rb->meta, cond, val, proc);
+}
+
+static inline void sdc_shrb_itail_add(sdc_shrb_t *rb, int val, int proc) {
+  if (rb->local_atomics)
+    atomic_fetch_add((_Atomic int *)sdc_shrb_peer(rb, &rb->itail, proc), val);
+  else
+    shmem_atomic_fetch_add(&rb->itail, val, proc);
+}
+
+/* copy nbytes at symmetric address src on proc, memcpy if proc is mapped */
+static inline void sdc_shrb_getmem(sdc_shrb_t *rb, void *dst, void *src, size_t nbytes, int proc) {
+  if (rb->peers[proc])
+    memcpy(dst, sdc_shrb_peer(rb, src, proc), nbytes);
+  else
+    shmem_getmem_nbi(dst, src, nbytes, proc);
+}
+
+
+/* thieves move the tail with remote atomics, so read it atomically as well */
+static inline int sdc_shrb_tail(sdc_shrb_t *rb) {
+  return sdc_meta_tail(sdc_shrb_meta_fetch(rb, rb->procid));
+}
+
+
+/* move the split and publish it to thieves */
+static inline void sdc_shrb_set_split(sdc_shrb_t *rb, int split) {
+  sdc_shrb_meta_add(rb, (uint64_t)(int64_t)(split - rb->split) << SDC_SPLIT_SHIFT, rb->procid);
+  rb->split = split;
+}
+
+
 sdc_shrb_t *sdc_shrb_create(int elem_size, int max_size, tc_t *tc) {
   GTC_ENTRY();
   sdc_shrb_t  *rb;
@@ -74,17 +143,39 @@ sdc_shrb_t *sdc_shrb_create(int elem_size, int max_size, tc_t *tc) {
 
   gtc_lprintf(DBGSHRB, "  Thread %d: sdc_shrb_create()\n", procid);
 
-  // Allocate the struct and the buffer contiguously in shared space
-  rb = gtc_shmem_malloc(sizeof(sdc_shrb_t) + elem_size*max_size);
+  // tail, split and max_size are packed into meta, larger queues can't be encoded
+  if (max_size > SDC_MAX_QUEUE_SIZE) {
+    gtc_eprintf(DBGERR, "sdc_shrb_create: queue size %d exceeds SDC limit of %"PRId64" (rebuild with larger SDC_INDEX_BITS)\n",
+        max_size, SDC_MAX_QUEUE_SIZE);
+    exit(1);
+  }
+
+  // Allocate the struct and the buffer contiguously in shared space, line aligned so the
+  // padding in sdc_shrb_t keeps tail and itail apart
+  rb = gtc_shmem_align(GTC_CACHE_LINE, sizeof(sdc_shrb_t) + elem_size*max_size);
 
   rb->procid  = procid;
   rb->nproc  = nproc;
   rb->elem_size = elem_size;
   rb->max_size  = max_size;
+  rb->stats     = gtc_calloc(1, sizeof(sdc_shrb_stats_t));
+  rb->spill     = NULL;
+  rb->spill_max = 0;
+  rb->lockfree  = tc->qtype == GtcQueueSDCLF;
+  rb->peers     = gtc_calloc(nproc, sizeof(void *));
+  rb->local_atomics = gtc_map_peers(rb, rb->peers);
   sdc_shrb_reset(rb);
 
   rb->tc = tc;
 
+#ifdef SDC_NODC
+  // without deferred copy, the lock is what keeps the owner from reclaiming in-flight tasks
+  if (rb->lockfree) {
+    gtc_eprintf(DBGERR, "sdc_shrb_create: lock-free SDC queue requires deferred copy\n");
+    exit(1);
+  }
+#endif
+
   // Initialize the lock
   synch_mutex_init(&rb->lock);
 
@@ -98,24 +189,32 @@ void sdc_shrb_reset(sdc_shrb_t *rb) {
   GTC_ENTRY();
   // Reset state to empty
   rb->nlocal = 0;
-  rb->tail   = 0;
   rb->itail  = 0;
   rb->vtail  = 0;
   rb->split  = 0;
+  rb->meta   = (uint64_t)rb->max_size << SDC_SIZE_SHIFT; // tail == split == 0
 
   rb->waiting= 0;
+  rb->nspill     = 0;
+  rb->spill_hwm  = 0;
 
   // Reset queue statistics
-  rb->nrelease   = 0;
-  rb->nreacquire = 0;
-  rb->nwaited    = 0;
-  rb->nreclaimed = 0;
+  rb->stats->nrelease   = 0;
+  rb->stats->nreacquire = 0;
+  rb->stats->nwaited    = 0;
+  rb->stats->nreclaimed = 0;
+  rb->stats->nspilled   = 0;
   GTC_EXIT();
 }
 
 
 void sdc_shrb_destroy(sdc_shrb_t *rb) {
   GTC_ENTRY();
+  free(rb->stats);
+  free(rb->peers);
+  if (rb->spill)
+    free(rb->spill);
+  synch_mutex_destroy(&rb->lock);
   shmem_free(rb);
   GTC_EXIT();
 }
@@ -128,7 +227,7 @@ void sdc_shrb_print(sdc_shrb_t *rb) {
   printf("   nlocal    = %d\n", rb->nlocal);
   printf("   head      = %d\n", sdc_shrb_head(rb));
   printf("   split     = %d\n", rb->split);
-  printf("   tail      = %d\n", rb->tail);
+  printf("   tail      = %d\n", sdc_shrb_tail(rb));
   printf("   itail     = %d\n", rb->itail);
   printf("   vtail     = %d\n", rb->vtail);
   printf("   max_size  = %d\n", rb->max_size);
@@ -137,6 +236,7 @@ void sdc_shrb_print(sdc_shrb_t *rb) {
   printf("   shared_size= %d\n", sdc_shrb_shared_size(rb));
   printf("   public_size= %d\n", sdc_shrb_public_size(rb));
   printf("   size       = %d\n", sdc_shrb_size(rb));
+  printf("   spill      = %d (hwm %d)\n", rb->nspill, rb->spill_hwm);
   printf("}\n");
   GTC_EXIT();
 }
@@ -144,6 +244,37 @@ void sdc_shrb_print(sdc_shrb_t *rb) {
 /*==================== STATE QUERIES ====================*/
 
 
+/*
+ * Fetch proc's packed queue state, see sdc_meta_*().
+ */
+uint64_t sdc_shrb_probe(sdc_shrb_t *rb, int proc) {
+  return sdc_shrb_meta_fetch(rb, proc);
+}
+
+
+/*
+ * Probe n victims at once: their metadata words are read with non-blocking gets and one quiet,
+ * so the round trips overlap.  The sizes are hints, steals check the metadata again.
+ */
+void sdc_shrb_probe_n(void *b, int *procs, int n, int *sizes) {
+  sdc_shrb_t *rb = (sdc_shrb_t *)b;
+  uint64_t    meta[GTC_MAX_PROBE_WIDTH];
+
+  assert(n <= GTC_MAX_PROBE_WIDTH);
+
+  for (int i = 0; i < n; i++) {
+    if (rb->local_atomics)
+      meta[i] = sdc_shrb_meta_fetch(rb, procs[i]);
+    else
+      sdc_shrb_getmem(rb, &meta[i], &rb->meta, sizeof(uint64_t), procs[i]);
+  }
+  shmem_quiet();
+
+  for (int i = 0; i < n; i++)
+    sizes[i] = sdc_meta_shared_size(meta[i]);
+}
+
+
 int sdc_shrb_head(sdc_shrb_t *rb) {
   return (rb->split + rb->nlocal - 1) % rb->max_size;
 }
@@ -155,7 +286,7 @@ int sdc_shrb_local_isempty(sdc_shrb_t *rb) {
 
 
 int sdc_shrb_shared_isempty(sdc_shrb_t *rb) {
-  return rb->tail == rb->split;
+  return sdc_shrb_tail(rb) == rb->split;
 }
 
 
@@ -170,18 +301,13 @@ int sdc_shrb_local_size(sdc_shrb_t *rb) {
 
 
 int sdc_shrb_shared_size(sdc_shrb_t *rb) {
-  if (sdc_shrb_shared_isempty(rb)) // Shared is empty
-    return 0;
-  else if (rb->tail < rb->split)   // No wrap-around
-    return rb->split - rb->tail;
-  else                             // Wrap-around
-    return rb->split + rb->max_size - rb->tail;
+  return sdc_shrb_span(sdc_shrb_tail(rb), rb->split, rb->max_size);
 }
 
 
 int sdc_shrb_public_size(sdc_shrb_t *rb) {
   if (rb->vtail == rb->split) {    // Public is empty
-    assert (rb->tail == rb->itail && rb->tail == rb->split);
+    assert (sdc_shrb_tail(rb) == rb->itail && sdc_shrb_tail(rb) == rb->split);
     return 0;
   }
   else if (rb->vtail < rb->split)  // No wrap-around
@@ -193,7 +319,12 @@ int sdc_shrb_public_size(sdc_shrb_t *rb) {
 
 int sdc_shrb_size(void *b) {
   sdc_shrb_t *rb = (sdc_shrb_t *)b;
-  return sdc_shrb_local_size(rb) + sdc_shrb_shared_size(rb);
+  return sdc_shrb_local_size(rb) + sdc_shrb_shared_size(rb) + rb->nspill;
+}
+
+
+static inline int sdc_shrb_free_space(sdc_shrb_t *rb) {
+  return rb->max_size - (sdc_shrb_local_size(rb) + sdc_shrb_public_size(rb));
 }
 
 
@@ -223,7 +354,7 @@ int sdc_shrb_reclaim_space(sdc_shrb_t *rb) {
   int reclaimed = 0;
   int vtail = rb->vtail;
   int itail = rb->itail; // Capture these values since we are doing this
-  int tail  = rb->tail;  // without a lock
+  int tail  = sdc_shrb_tail(rb);  // without a lock
   TC_START_TIMER(rb->tc, reclaim);
   if (vtail != tail && itail == tail) {
     rb->vtail = tail;
@@ -235,41 +366,76 @@ int sdc_shrb_reclaim_space(sdc_shrb_t *rb) {
     assert(reclaimed > 0);
   }
 
-  rb->nreccalls++;
+  rb->stats->nreccalls++;
   TC_STOP_TIMER(rb->tc, reclaim);
   GTC_EXIT(reclaimed);
 }
 
 
 
-void sdc_shrb_ensure_space(sdc_shrb_t *rb, int n) {
+/*
+ * Make room for n elements in the ring.  Returns 0 if there isn't enough room even after
+ * all deferred copies finish, the caller spills instead.
+ */
+int sdc_shrb_ensure_space(sdc_shrb_t *rb, int n) {
   GTC_ENTRY();
+  int room = 1;
+
   // Ensure that there is enough free space in the queue.  If there isn't
   // wait until others finish their deferred copies so we can reclaim space.
   TC_START_TIMER(rb->tc, ensure);
-  if (rb->max_size - (sdc_shrb_local_size(rb) + sdc_shrb_public_size(rb)) < n) {
+  if (sdc_shrb_free_space(rb) < n) {
     sdc_shrb_lock(rb, rb->procid);
     {
-      if (rb->max_size - sdc_shrb_size(rb) < n) {
-        // Error: amount of reclaimable space is less than what we need.
-        // Try increasing the size of the queue.
-        printf("SDC_SHRB: Error, not enough space in the queue to push %d elements\n", n);
-        sdc_shrb_print(rb);
-        assert(0);
+      if (rb->max_size - (sdc_shrb_local_size(rb) + sdc_shrb_shared_size(rb)) < n) {
+        // reclaimable space is less than what we need
+        gtc_lprintf(DBGSHRB, "not enough space in the queue for %d elements, spilling\n", n);
+        room = 0;
+      } else {
+        rb->waiting = 1;
+        while (sdc_shrb_reclaim_space(rb) == 0) /* Busy Wait */ ;
+        rb->waiting = 0;
+        rb->stats->nwaited++;
       }
-      rb->waiting = 1;
-      while (sdc_shrb_reclaim_space(rb) == 0) /* Busy Wait */ ;
-      rb->waiting = 0;
-      rb->nwaited++;
     }
     sdc_shrb_unlock(rb, rb->procid);
   }
   TC_STOP_TIMER(rb->tc, ensure);
-  GTC_EXIT();
+  GTC_EXIT(room);
 }
 
 
 
+/*
+ * STEAL_WORK: publish the steal schedule for the n shared elements starting at tail.  Each
+ * steal takes the oldest tasks that hold at least half of the estimated work still left, and
+ * the last step allowed takes everything that remains.
+ */
+static void sdc_shrb_build_work_schedule(sdc_shrb_t *rb, int tail, int n) {
+  sdc_work_sched_t *ws = &rb->wsched;
+  double left = 0.0, work;
+  int    claimed = 0, k, m;
+
+  for (int i = 0; i < n; i++)
+    left += gtc_task_cost(rb->tc, (task_t *)sdc_shrb_elem_addr(rb, rb->procid, (tail + i) % rb->max_size));
+
+  ws->base      = tail;
+  ws->offset[0] = 0;
+  for (k = 0; claimed < n; k++) {
+    if (k == SDC_MAX_WORK_STEPS-1) {
+      m = n - claimed;
+    } else {
+      for (m = 0, work = 0.0; claimed + m < n && (m == 0 || work < left/2); m++)
+        work += gtc_task_cost(rb->tc, (task_t *)sdc_shrb_elem_addr(rb, rb->procid, (tail + claimed + m) % rb->max_size));
+      left -= work;
+    }
+    claimed += m;
+    ws->offset[k+1] = claimed;
+  }
+  ws->nsteps = k;
+}
+
+
 void sdc_shrb_release(sdc_shrb_t *rb) {
   GTC_ENTRY();
   // Favor placing work in the shared portion -- if there is only one task
@@ -277,9 +443,11 @@ void sdc_shrb_release(sdc_shrb_t *rb) {
   TC_START_TIMER(rb->tc, release);
   if (sdc_shrb_local_size(rb) > 0 && sdc_shrb_shared_size(rb) == 0) {
     int amount  = sdc_shrb_local_size(rb)/2 + sdc_shrb_local_size(rb) % 2;
+    if (rb->tc->ldbal_cfg.steal_method == STEAL_WORK)
+      sdc_shrb_build_work_schedule(rb, rb->split, amount); // shared is empty, so the tail is at the split
     rb->nlocal -= amount;
-    rb->split   = (rb->split + amount) % rb->max_size;
-    rb->nrelease++;
+    sdc_shrb_set_split(rb, (rb->split + amount) % rb->max_size);
+    rb->stats->nrelease++;
     gtc_lprintf(DBGSHRB, "release: local size: %d shared size: %d\n", sdc_shrb_local_size(rb), sdc_shrb_shared_size(rb));
   }
   TC_STOP_TIMER(rb->tc, release);
@@ -290,18 +458,63 @@ void sdc_shrb_release(sdc_shrb_t *rb) {
 void sdc_shrb_release_all(sdc_shrb_t *rb) {
   GTC_ENTRY();
   int amount  = sdc_shrb_local_size(rb);
+  if (rb->tc->ldbal_cfg.steal_method == STEAL_WORK) {
+    int tail = sdc_shrb_tail(rb);
+    sdc_shrb_build_work_schedule(rb, tail, sdc_shrb_span(tail, (rb->split + amount) % rb->max_size, rb->max_size));
+  }
   rb->nlocal -= amount;
-  rb->split   = (rb->split + amount) % rb->max_size;
-  rb->nrelease++;
+  sdc_shrb_set_split(rb, (rb->split + amount) % rb->max_size);
+  rb->stats->nrelease++;
   GTC_EXIT();
 }
 
 
+/*
+ * Lock-free reacquire: pull the split back with a CAS so it can't cross a tail that a thief
+ * is concurrently advancing.  A failed CAS returns the current state, size against that.
+ */
+static int sdc_shrb_reacquire_cas(sdc_shrb_t *rb) {
+  uint64_t meta, old;
+  int shared, diff, split, amount;
+
+  meta = sdc_shrb_probe(rb, rb->procid);
+  for (;;) {
+    shared = sdc_meta_shared_size(meta);
+    if (shared <= sdc_shrb_local_size(rb))
+      return 0;
+
+    diff   = shared - sdc_shrb_local_size(rb);
+    amount = diff/2 + diff % 2;
+    split  = (rb->split - amount + rb->max_size) % rb->max_size;
+
+    old = sdc_shrb_meta_cas(rb, meta, sdc_meta_with_split(meta, split), rb->procid);
+    if (old == meta)
+      break;
+    meta = old;
+  }
+
+  rb->nlocal += amount;
+  rb->split   = split;
+  return amount;
+}
+
+
 int sdc_shrb_reacquire(sdc_shrb_t *rb) {
   GTC_ENTRY();
   int amount = 0;
 
   TC_START_TIMER(rb->tc, reacquire);
+  if (rb->lockfree) {
+    amount = sdc_shrb_reacquire_cas(rb);
+    if (amount > 0) {
+      rb->stats->nreacquire++;
+      gtc_lprintf(DBGSHRB, "reacquire: local size: %d shared size: %d\n", sdc_shrb_local_size(rb), sdc_shrb_shared_size(rb));
+    }
+    assert(!sdc_shrb_local_isempty(rb) || sdc_shrb_isempty(rb));
+    TC_STOP_TIMER(rb->tc, reacquire);
+    GTC_EXIT(amount);
+  }
+
   // Favor placing work in the local portion -- if there is only one task
   // available this scheme will put it in the local portion.
   sdc_shrb_lock(rb, rb->procid);
@@ -310,10 +523,8 @@ int sdc_shrb_reacquire(sdc_shrb_t *rb) {
       int diff    = sdc_shrb_shared_size(rb) - sdc_shrb_local_size(rb);
       amount      = diff/2 + diff % 2;
       rb->nlocal += amount;
-      rb->split   = (rb->split - amount);
-      if (rb->split < 0)
-        rb->split += rb->max_size;
-      rb->nreacquire++;
+      sdc_shrb_set_split(rb, (rb->split - amount + rb->max_size) % rb->max_size);
+      rb->stats->nreacquire++;
       gtc_lprintf(DBGSHRB, "reacquire: local size: %d shared size: %d\n", sdc_shrb_local_size(rb), sdc_shrb_shared_size(rb));
     }
 
@@ -330,33 +541,97 @@ int sdc_shrb_reacquire(sdc_shrb_t *rb) {
 /*==================== PUSH OPERATIONS ====================*/
 
 
-static inline void sdc_shrb_push_n_head_impl(sdc_shrb_t *rb, int proc, void *e, int n, int size) {
+/*
+ * Copy n elements onto the head of the ring, the caller has made sure they fit.
+ */
+static inline void sdc_shrb_ring_push(sdc_shrb_t *rb, void *e, int n, int size) {
   int head, old_head;
 
-  assert(size <= rb->elem_size);
-  assert(size == rb->elem_size || n == 1);  // n > 1 ==> size == rb->elem_size
-  assert(proc == rb->procid);
-  TC_START_TIMER(rb->tc, pushhead);
-
-  // Make sure there is enough space for n elements
-  sdc_shrb_ensure_space(rb, n);
-
-  // Proceed with the push
   old_head    = sdc_shrb_head(rb);
   rb->nlocal += n;
   head        = sdc_shrb_head(rb);
 
   if (head > old_head || old_head == rb->max_size - 1) {
-    memcpy(sdc_shrb_elem_addr(rb, proc, (old_head+1)%rb->max_size), e, n*size);
+    memcpy(sdc_shrb_elem_addr(rb, rb->procid, (old_head+1)%rb->max_size), e, n*size);
   }
 
   // This push wraps around, break it into two parts
   else {
     int part_size = rb->max_size - 1 - old_head;
 
-    memcpy(sdc_shrb_elem_addr(rb, proc, old_head+1), e, part_size*size);
-    memcpy(sdc_shrb_elem_addr(rb, proc, 0), sdc_shrb_buff_elem_addr(rb, e, part_size), (n - part_size)*size);
+    memcpy(sdc_shrb_elem_addr(rb, rb->procid, old_head+1), e, part_size*size);
+    memcpy(sdc_shrb_elem_addr(rb, rb->procid, 0), sdc_shrb_buff_elem_addr(rb, e, part_size), (n - part_size)*size);
   }
+}
+
+/*
+ * Reserve n elements on top of the private spill stack, growing it as needed.  Pushes go
+ * to the spill while the ring is full, pop_head drains it first and sdc_shrb_refill()
+ * moves it back into the ring as space frees up.
+ */
+static void *sdc_shrb_spill_reserve(sdc_shrb_t *rb, int n) {
+  void *e;
+
+  if (rb->nspill + n > rb->spill_max) {
+    int max = rb->spill_max ? rb->spill_max : 64;
+
+    while (max < rb->nspill + n)
+      max *= 2;
+    rb->spill = realloc(rb->spill, (size_t)max * rb->elem_size);
+    if (!rb->spill) {
+      gtc_eprintf(DBGERR, "sdc_shrb: unable to grow the spill to %d elements\n", max);
+      exit(1);
+    }
+    rb->spill_max = max;
+  }
+
+  e = sdc_shrb_buff_elem_addr(rb, rb->spill, rb->nspill);
+  rb->nspill   += n;
+  rb->stats->nspilled += n;
+  if (rb->nspill > rb->spill_hwm)
+    rb->spill_hwm = rb->nspill;
+  return e;
+}
+
+/*
+ * Move as much of the spill as fits back into the ring, oldest first.  Returns the number
+ * of elements moved.
+ */
+int sdc_shrb_refill(sdc_shrb_t *rb) {
+  GTC_ENTRY();
+  int n;
+
+  if (rb->nspill == 0)
+    GTC_EXIT(0);
+
+  if (sdc_shrb_free_space(rb) < rb->nspill)
+    sdc_shrb_reclaim_space(rb);
+
+  n = sdc_shrb_free_space(rb);
+  if (n > rb->nspill)
+    n = rb->nspill;
+
+  if (n > 0) {
+    sdc_shrb_ring_push(rb, rb->spill, n, rb->elem_size);
+    rb->nspill -= n;
+    memmove(rb->spill, sdc_shrb_buff_elem_addr(rb, rb->spill, n), (size_t)rb->nspill * rb->elem_size);
+  }
+  GTC_EXIT(n);
+}
+
+static inline void sdc_shrb_push_n_head_impl(sdc_shrb_t *rb, int proc, void *e, int n, int size) {
+  assert(size <= rb->elem_size);
+  assert(size == rb->elem_size || n == 1);  // n > 1 ==> size == rb->elem_size
+  assert(proc == rb->procid);
+  TC_START_TIMER(rb->tc, pushhead);
+
+  // Make sure there is enough space for n elements, anything already in the spill is
+  // newer than the ring so keep spilling until it has been refilled
+  if (rb->nspill > 0 || !sdc_shrb_ensure_space(rb, n))
+    memcpy(sdc_shrb_spill_reserve(rb, n), e, n*size);
+  else
+    sdc_shrb_ring_push(rb, e, n, size);
+
   TC_STOP_TIMER(rb->tc, pushhead);
 }
 
@@ -369,7 +644,10 @@ void sdc_shrb_push_head(sdc_shrb_t *rb, int proc, void *e, int size) {
   assert(proc == rb->procid);
 
   // Make sure there is enough space for n elements
-  sdc_shrb_ensure_space(rb, 1);
+  if (rb->nspill > 0 || !sdc_shrb_ensure_space(rb, 1)) {
+    memcpy(sdc_shrb_spill_reserve(rb, 1), e, size);
+    GTC_EXIT();
+  }
 
   // Proceed with the push
   old_head    = sdc_shrb_head(rb);
@@ -392,7 +670,8 @@ void sdc_shrb_push_n_head(void *b, int proc, void *e, int n) {
 void *sdc_shrb_alloc_head(sdc_shrb_t *rb) {
   GTC_ENTRY();
   // Make sure there is enough space for 1 element
-  sdc_shrb_ensure_space(rb, 1);
+  if (rb->nspill > 0 || !sdc_shrb_ensure_space(rb, 1))
+    GTC_EXIT(sdc_shrb_spill_reserve(rb, 1));
 
   rb->nlocal += 1;
 
@@ -410,6 +689,13 @@ int sdc_shrb_pop_head(void *b, int proc, void *buf) {
 
   assert(proc == rb->procid);
 
+  // spilled elements are the newest
+  if (rb->nspill > 0) {
+    rb->nspill--;
+    memcpy(buf, sdc_shrb_buff_elem_addr(rb, rb->spill, rb->nspill), rb->elem_size);
+    GTC_EXIT(1);
+  }
+
   // If we are out of local work, try to reacquire
   if (sdc_shrb_local_isempty(rb))
     sdc_shrb_reacquire(rb);
@@ -453,71 +739,231 @@ int sdc_shrb_pop_tail(sdc_shrb_t *rb, int proc, void *buf) {
  *  @return      The number of tasks stolen or -1 on failure
  */
 
-static inline int sdc_shrb_pop_n_tail_impl(sdc_shrb_t *myrb, int proc, int n, void *e, int steal_vol, int trylock) {
-  sdc_shrb_t trb;
-  TC_START_TIMER(myrb->tc, poptail);
-  __gtc_marker[1] = 3;
-  // Attempt to get the lock
-  if (trylock) {
-    if (!sdc_shrb_trylock(myrb, proc)) {
-      return -1;
-    }
-  } else {
-    sdc_shrb_lock(myrb, proc);
+/*
+ * Non-blocking fetch of count elements starting at index src of proc's queue into our own
+ * queue starting at index dst, splitting the transfer wherever either block wraps.
+ */
+static inline void sdc_shrb_get_ring(sdc_shrb_t *rb, int dst, int proc, int src, int count) {
+  while (count > 0) {
+    int part_size = count;
+
+    if (part_size > rb->max_size - src)
+      part_size = rb->max_size - src;
+    if (part_size > rb->max_size - dst)
+      part_size = rb->max_size - dst;
+
+    sdc_shrb_getmem(rb, sdc_shrb_elem_addr(rb, rb->procid, dst), sdc_shrb_elem_addr(rb, proc, src), part_size * rb->elem_size, proc);
+
+    count -= part_size;
+    src    = (src + part_size) % rb->max_size;
+    dst    = (dst + part_size) % rb->max_size;
   }
+}
+
 
-  // Copy the remote RB's metadata
-  shmem_getmem(&trb, myrb, sizeof(sdc_shrb_t), proc);
 
+/*
+ * Number of elements to take out of a victim sharing shared elements, given a request for n.
+ */
+static inline int sdc_shrb_steal_volume(int shared, int n, int steal_vol) {
   switch (steal_vol) {
     case STEAL_HALF:
-      n = MIN(sdc_shrb_shared_size(&trb)/2 + sdc_shrb_shared_size(&trb) % 2, n);
-      break;
+      return MIN(shared/2 + shared % 2, n);
     case STEAL_ALL:
-      n = MIN(sdc_shrb_shared_size(&trb), n);
-      break;
+      return MIN(shared, n);
     case STEAL_CHUNK:
       // Get as much as possible up to N.
-      n = MIN(n, sdc_shrb_shared_size(&trb));
-      break;
+      return MIN(n, shared);
     default:
       printf("Error: Unknown steal volume heuristic.\n");
       assert(0);
   }
+  return 0;
+}
+
 
-  // Reserve N elements by advancing the victim's tail
+/*
+ * Fetch proc's published STEAL_WORK schedule into ws.  Returns ws, or NULL when the steal
+ * doesn't use one or there is nothing shared to size it against.
+ */
+static inline sdc_work_sched_t *sdc_shrb_fetch_work_sched(sdc_shrb_t *myrb, int proc, uint64_t meta, int steal_vol,
+                                                          sdc_work_sched_t *ws) {
+  if (steal_vol != STEAL_WORK || sdc_meta_shared_size(meta) == 0)
+    return NULL;
+
+  sdc_shrb_getmem(myrb, ws, &myrb->wsched, sizeof(*ws), proc);
+  if (!myrb->peers[proc])
+    shmem_quiet();
+  return ws;
+}
+
+
+/*
+ * STEAL_WORK volume: find the victim's tail in its published schedule and take the rest of
+ * that step, or half the elements when there is no schedule or it doesn't cover the tail.
+ * The schedule is only a hint, the result is always between 1 and min(n, shared), or 0 when
+ * either is 0.
+ */
+static inline int sdc_shrb_work_volume(sdc_work_sched_t *ws, uint64_t meta, int n) {
+  int shared = sdc_meta_shared_size(meta);
+  int nsteps, pos = 0, k, count;
+
+  if (n <= 0 || shared == 0)
+    return 0;
+
+  nsteps = ws ? ws->nsteps : 0;
+  if (nsteps < 0 || nsteps > SDC_MAX_WORK_STEPS)
+    nsteps = 0;
+  if (nsteps > 0)
+    pos = sdc_shrb_span(ws->base, sdc_meta_tail(meta), sdc_meta_max_size(meta));
+  for (k = 0; k < nsteps && ws->offset[k+1] <= pos; k++)
+    ;
+  if (k == nsteps)
+    return sdc_shrb_steal_volume(shared, n, STEAL_HALF);
+
+  count = ws->offset[k+1] - pos;
+  if (count > shared) count = shared;
+  if (count > n)      count = n;
+  return (count > 0) ? count : 1;
+}
+
+
+/*
+ * Number of elements to take out of a queue in state meta, given a request for n.  ws is the
+ * victim's schedule from sdc_shrb_fetch_work_sched(), only used by STEAL_WORK.
+ */
+static inline int sdc_shrb_volume(sdc_work_sched_t *ws, uint64_t meta, int n, int steal_vol) {
+  if (steal_vol == STEAL_WORK)
+    return sdc_shrb_work_volume(ws, meta, n);
+  return sdc_shrb_steal_volume(sdc_meta_shared_size(meta), n, steal_vol);
+}
+
+
+/*
+ * Lock-free reservation: size the steal from the probed state and CAS the advanced tail into
+ * the victim's meta word, re-sizing against the returned state when the CAS loses a race.
+ * Returns the number of elements reserved with *meta holding the state they were reserved
+ * against, or -1 if a try_ steal lost a race.
+ */
+static inline int sdc_shrb_reserve_cas(sdc_shrb_t *myrb, int proc, int n, int steal_vol, int try, uint64_t *meta) {
+  sdc_work_sched_t  wsbuf, *ws;
+  uint64_t          old;
+  int               count;
+
+  // the schedule is a hint, one fetch serves every retry
+  *meta = sdc_shrb_probe(myrb, proc);
+  ws    = sdc_shrb_fetch_work_sched(myrb, proc, *meta, steal_vol, &wsbuf);
+  for (;;) {
+    count = sdc_shrb_volume(ws, *meta, n, steal_vol);
+    if (count <= 0)
+      return 0;
+
+    old = sdc_shrb_meta_cas(myrb, *meta,
+            sdc_meta_with_tail(*meta, (sdc_meta_tail(*meta) + count) % sdc_meta_max_size(*meta)), proc);
+    if (old == *meta)
+      return count;
+    if (try)
+      return -1;
+    *meta = old;
+  }
+}
+
+
+/* Pop up to N elements off the tail of proc's queue into e, or directly onto the head of
+ * myrb's local portion when e is NULL.  Returns the number of tasks stolen or -1 if the
+ * trylock failed.
+ */
+static inline int sdc_shrb_pop_n_tail_impl(sdc_shrb_t *myrb, int proc, int n, void *e, int steal_vol, int trylock) {
+  sdc_work_sched_t wsbuf;
+  uint64_t meta;
+  int tail, max_size;
+  TC_START_TIMER(myrb->tc, poptail);
+  __gtc_marker[1] = 3;
+
+  // stealing in place: only take what fits in our own queue without waiting, so we never
+  // need our own lock while holding the victim's
+  if (e == NULL) {
+    if (myrb->max_size - (sdc_shrb_local_size(myrb) + sdc_shrb_public_size(myrb)) < n)
+      sdc_shrb_reclaim_space(myrb);
+    n = MIN(n, myrb->max_size - (sdc_shrb_local_size(myrb) + sdc_shrb_public_size(myrb)));
+  }
+  if (myrb->lockfree) {
+    n = sdc_shrb_reserve_cas(myrb, proc, n, steal_vol, trylock, &meta);
+    if (n < 0) {
+      TC_STOP_TIMER(myrb->tc, poptail);
+      __gtc_marker[1] = 0;
+      return -1;
+    }
+    tail     = sdc_meta_tail(meta);
+    max_size = sdc_meta_max_size(meta);
+
+  } else {
+    // Attempt to get the lock
+    if (trylock) {
+      if (!sdc_shrb_trylock(myrb, proc)) {
+        TC_STOP_TIMER(myrb->tc, poptail);
+        __gtc_marker[1] = 0;
+        return -1;
+      }
+    } else {
+      sdc_shrb_lock(myrb, proc);
+    }
+
+    // Probe the remote RB's tail and split
+    meta     = sdc_shrb_probe(myrb, proc);
+    tail     = sdc_meta_tail(meta);
+    max_size = sdc_meta_max_size(meta);
+    n        = sdc_shrb_volume(sdc_shrb_fetch_work_sched(myrb, proc, meta, steal_vol, &wsbuf), meta, n, steal_vol);
+
+    // Reserve N elements by advancing the victim's tail
+    if (n > 0) {
+      sdc_shrb_meta_add(myrb, (uint64_t)(int64_t)((tail + n) % max_size - tail), proc);
+      shmem_fence(); // the reservation must land before the unlock
+    }
+  }
+
+  // Copy out the N reserved elements
   if (n > 0) {
     int  new_tail;
-    // int  metadata;
-    int  xfer_size;
-    int *loc_addr, *rem_addr;
+    int  mapped = myrb->peers[proc] != NULL;
 
-    new_tail    = ((&trb)->tail + n) % (&trb)->max_size;
+    new_tail    = (tail + n) % max_size;
+
+    if (!myrb->lockfree)
+      sdc_shrb_unlock(myrb, proc); // Deferred copy unlocks early
+
+    myrb->stats->nsteals++;
+    if (mapped) {
+      myrb->stats->nlocalsteals++;
+      atomic_thread_fence(memory_order_acquire); // read the tasks only after the reservation
+    }
 
-    loc_addr    = &new_tail;
-    rem_addr    = &myrb->tail;
-    xfer_size   = 1*sizeof(int);
-    shmem_putmem(rem_addr, loc_addr, xfer_size, proc);
+    // Transfer work directly above our head
+    if (e == NULL) {
 
-    sdc_shrb_unlock(myrb, proc); // Deferred copy unlocks early
+      sdc_shrb_get_ring(myrb, (sdc_shrb_head(myrb) + 1) % myrb->max_size, proc, tail, n);
+      myrb->nlocal += n;
 
     // Transfer work into the local buffer
-    if ((&trb)->tail + (n-1) < (&trb)->max_size) {    // No need to wrap around
+    } else if (tail + (n-1) < max_size) {    // No need to wrap around
 
-      shmem_getmem_nbi(e, sdc_shrb_elem_addr(myrb, proc, (&trb)->tail), n * (&trb)->elem_size, proc);    // Store n elems, starting at remote tail, in e
-      shmem_quiet();
+      sdc_shrb_getmem(myrb, e, sdc_shrb_elem_addr(myrb, proc, tail), n * myrb->elem_size, proc);    // Store n elems, starting at remote tail, in e
 
     } else {    // Need to wrap around
-      int part_size  = (&trb)->max_size - (&trb)->tail;
-
-      shmem_getmem_nbi(sdc_shrb_buff_elem_addr(&trb, e, 0), sdc_shrb_elem_addr(myrb, proc, (&trb)->tail), part_size * (&trb)->elem_size, proc);
+      int part_size  = max_size - tail;
 
-      shmem_getmem_nbi(sdc_shrb_buff_elem_addr(&trb, e, part_size), sdc_shrb_elem_addr(myrb, proc, 0), (n - part_size) * (&trb)->elem_size, proc);
+      sdc_shrb_getmem(myrb, sdc_shrb_buff_elem_addr(myrb, e, 0), sdc_shrb_elem_addr(myrb, proc, tail), part_size * myrb->elem_size, proc);
 
-      shmem_quiet();
+      sdc_shrb_getmem(myrb, sdc_shrb_buff_elem_addr(myrb, e, part_size), sdc_shrb_elem_addr(myrb, proc, 0), (n - part_size) * myrb->elem_size, proc);
 
     }
 
+    // wait for the gets, or finish our loads before the victim can reuse the slots
+    if (mapped)
+      atomic_thread_fence(memory_order_release);
+    else
+      shmem_quiet();
+
 #ifndef SDC_NODC
     // Accumulate itail_inc onto the victim's intermediate tail
     {
@@ -526,13 +972,14 @@ static inline int sdc_shrb_pop_n_tail_impl(sdc_shrb_t *myrb, int proc, int n, vo
       //int count = sizeof(int);
 
       // How much should we add to the itail?  If we caused a wraparound, we need to also wrap itail.
-      if (new_tail > (&trb)->tail)
+      if (new_tail > tail)
         itail_inc = n;
       else
-        itail_inc = n - (&trb)->max_size;
-      shmem_atomic_fetch_add(&(myrb->itail), itail_inc, proc);
+        itail_inc = n - max_size;
+      sdc_shrb_itail_add(myrb, itail_inc, proc);
 
-      shmem_quiet();
+      if (!myrb->local_atomics)
+        shmem_quiet();
     }
 #else
     shmem_quiet();
@@ -540,7 +987,8 @@ static inline int sdc_shrb_pop_n_tail_impl(sdc_shrb_t *myrb, int proc, int n, vo
 #endif
 
   } else /* (n <= 0) */ {
-    sdc_shrb_unlock(myrb, proc);
+    if (!myrb->lockfree)
+      sdc_shrb_unlock(myrb, proc);
   }
   TC_STOP_TIMER(myrb->tc, poptail);
   __gtc_marker[1] = 0;
@@ -558,3 +1006,15 @@ int sdc_shrb_try_pop_n_tail(void *b, int proc, int n, void *e, int steal_vol) {
   sdc_shrb_t *myrb = (sdc_shrb_t *)b;
   GTC_EXIT(sdc_shrb_pop_n_tail_impl(myrb, proc, n, e, steal_vol, 1));
 }
+
+int sdc_shrb_steal_n_tail(void *b, int proc, int n, int steal_vol) {
+  GTC_ENTRY();
+  sdc_shrb_t *myrb = (sdc_shrb_t *)b;
+  GTC_EXIT(sdc_shrb_pop_n_tail_impl(myrb, proc, n, NULL, steal_vol, 0));
+}
+
+int sdc_shrb_try_steal_n_tail(void *b, int proc, int n, int steal_vol) {
+  GTC_ENTRY();
+  sdc_shrb_t *myrb = (sdc_shrb_t *)b;
+  GTC_EXIT(sdc_shrb_pop_n_tail_impl(myrb, proc, n, NULL, steal_vol, 1));
+}
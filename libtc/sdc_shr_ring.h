@@ -2,6 +2,7 @@
 #define __SDC_SHR_RING_H__
 
 #include <sys/types.h>
+#include <stdint.h>
 #include <shmem.h>
 #include <mutex.h>
 #include <tc.h>
@@ -33,23 +34,102 @@ typedef enum {
   SDCStealFailsLocked,
   SDCStealFailsUnlocked,
   SDCAbortedSteals,
+  SDCAbortedTargets,
   SDCProgressCalls,
   SDCReclaimCalls,
   SDCEnsureCalls,
   SDCReacquireCalls,
-  SDCReleaseCalls
+  SDCReleaseCalls,
+  SDCSpilled,
+  SDCSpillHWM,
+  SDCLocalSteals
 } gtc_sdc_gcountstats_e;
 
 
-struct sdc_shrb_s {
-  int             itail;     // Index of the intermediate tail (between vtail and tail)
-  int             tail;      // Index of tail element (between 0 and rb_size-1)
+/*
+ * Thief-visible queue state, packed so that probing a victim is a single 64-bit atomic fetch:
+ *
+ *   | tail : SDC_INDEX_BITS | split : SDC_INDEX_BITS | max_size : remaining bits |
+ *
+ * Thieves move tail (under the lock) and the owner moves split by atomically adding the signed
+ * change shifted into the field.  Both fields stay in [0, max_size), so the add never carries
+ * into a neighbouring field.  The owner keeps its own copy of split for the local fast path.
+ *
+ * In lock-free mode (GtcQueueSDCLF) thieves instead reserve by compare-and-swapping the whole
+ * word, and the owner pulls split back with a CAS as well, so a reservation only succeeds
+ * against exactly the tail and split it was sized for.
+ */
+#ifndef SDC_INDEX_BITS
+#define SDC_INDEX_BITS            21
+#endif
+#define SDC_SPLIT_SHIFT           SDC_INDEX_BITS
+#define SDC_SIZE_SHIFT            (2*SDC_INDEX_BITS)
+#define SDC_INDEX_MASK            ((1UL << SDC_INDEX_BITS) - 1)
+#define SDC_MAX_QUEUE_SIZE        ((int64_t)SDC_INDEX_MASK)
+
+#define sdc_meta_tail(M)          ((int)((M) & SDC_INDEX_MASK))
+#define sdc_meta_split(M)         ((int)(((M) >> SDC_SPLIT_SHIFT) & SDC_INDEX_MASK))
+#define sdc_meta_max_size(M)      ((int)((M) >> SDC_SIZE_SHIFT))
+#define sdc_meta_with_tail(M, T)  (((M) & ~SDC_INDEX_MASK) | (uint64_t)(T))
+#define sdc_meta_with_split(M, S) (((M) & ~(SDC_INDEX_MASK << SDC_SPLIT_SHIFT)) | ((uint64_t)(S) << SDC_SPLIT_SHIFT))
+
+/* number of elements between tail and split on a ring of max_size */
+static inline int sdc_shrb_span(int tail, int split, int max_size) {
+  return (tail <= split) ? split - tail : split + max_size - tail;
+}
+
+/* shared (stealable) portion described by a packed state word */
+static inline int sdc_meta_shared_size(uint64_t meta) {
+  return sdc_shrb_span(sdc_meta_tail(meta), sdc_meta_split(meta), sdc_meta_max_size(meta));
+}
+
+
+/*
+ * STEAL_WORK: on each release the owner splits the shared portion into steals that each take
+ * half of the estimated work left, as offsets from the tail the release started at.  Thieves
+ * fetch it to size their steal.  The reservation itself still goes through meta, so a stale or
+ * torn read only gives a worse split.
+ */
+#define SDC_MAX_WORK_STEPS        64
+
+struct sdc_work_sched_s {
+  int             base;      // tail the schedule starts at
+  int             nsteps;    // number of steals in the schedule
+  int             offset[SDC_MAX_WORK_STEPS+1]; // steal k starts offset[k] elements past base
+};
+typedef struct sdc_work_sched_s sdc_work_sched_t;
+
+
+/* Owner-private queue counters, kept off the queue header (see saws_shrb_stats_s) */
+struct sdc_shrb_stats_s {
+  tc_counter_t    nwaited;   // How many times did I have to wait
+  tc_counter_t    nreclaimed;// How many times did I reclaim space from the public portion of the queue
+  tc_counter_t    nreccalls; // How many times did I even try to reclaim
+  tc_counter_t    nrelease;  // Number of times work was released from local->public
+  tc_counter_t    nprogress; // Number of otimes we called the progress routine
+  tc_counter_t    nreacquire;// Number of times work was reacquired from public->local
+  tc_counter_t    ngets;     // Number of times we attempted a steal
+  tc_counter_t    nensure;   // Number of times we call reclaim space
+  tc_counter_t    nxfer;     // xferred bytes
+  tc_counter_t    nsteals;   // number of successful steals
+  tc_counter_t    nmeta;     // number of successful steals
+  tc_counter_t    nspilled;  // number of elements pushed into the spill
+  tc_counter_t    nlocalsteals; // successful steals from a victim mapped on this node
+};
+typedef struct sdc_shrb_stats_s sdc_shrb_stats_t;
 
+
+/*
+ * Header layout: thieves update the packed state word (under the lock) and itail (after dropping
+ * it), so each gets a cache line of its own, away from the owner's nlocal/split/vtail updates.
+ */
+struct sdc_shrb_s {
   int             nlocal;    // Number of elements in the local portion of the queue
   int             vtail;     // Index of the virtual tail
   int             split;     // index of split between local-only and local-shared elements
 
   synch_mutex_t   lock;      // lock for shared portion of this queue
+  int             lockfree;  // thieves reserve with a CAS on meta instead of taking the lock
   int             waiting;   // Am I currently waiting for transactions to complete?
   
   int             procid;
@@ -58,21 +138,22 @@ struct sdc_shrb_s {
   int             elem_size; // Size of an element in bytes
 
   tc_t           *tc;        // task collection associated with queue (for stats)
+  sdc_shrb_stats_t *stats;   // (private) queue counters
 
-  tc_counter_t    nwaited;   // How many times did I have to wait
-  tc_counter_t    nreclaimed;// How many times did I reclaim space from the public portion of the queue
-  tc_counter_t    nreccalls; // How many times did I even try to reclaim
-  tc_counter_t    nrelease;  // Number of times work was released from local->public
-  tc_counter_t    nprogress; // Number of otimes we called the progress routine
-  tc_counter_t    nreacquire;// Number of times work was reacquired from public->local
-  tc_counter_t    ngets;     // Number of times we attempted a steal
-  tc_counter_t    nensure;   // Number of times we call reclaim space
-  tc_counter_t    nxfer;     // xferred bytes
-  tc_counter_t    nsteals;   // number of successful steals
-  tc_counter_t    nmeta;     // number of successful steals
+  u_int8_t       *spill;     // (private) overflow stack above the local head, see sdc_shrb_refill()
+  int             nspill;    // Number of elements in the spill
+  int             spill_max; // Allocated size of the spill in number of elements
+  int             spill_hwm; // Spill high-water mark
 
   struct sdc_shrb_s **rbs;   // (private) array of base addrs for all rbs
-  u_int8_t        q[0];      // (shared)  ring buffer data.  This will be allocated
+  void          **peers;     // (private) each proc's queue mapped into our address space, NULL if off-node
+  int             local_atomics; // every queue is mapped, update meta/itail with CPU atomics
+
+  uint64_t        meta GTC_CACHE_ALIGNED;  // (remote) packed tail, split and max_size, see sdc_meta_*()
+  int             itail GTC_CACHE_ALIGNED; // (remote) Index of the intermediate tail (between vtail and tail)
+  sdc_work_sched_t wsched GTC_CACHE_ALIGNED; // (remote) STEAL_WORK steal schedule, written by the owner on release
+
+  u_int8_t        q[0] GTC_CACHE_ALIGNED;  // (shared)  ring buffer data.  This will be allocated
                              // contiguous with the rb_s so allocating an rb_s will
                              // require "sizeof(struct rb_s) + elem_size*rb_size"
 };
@@ -93,11 +174,14 @@ int         sdc_shrb_local_size(sdc_shrb_t *rb);
 int         sdc_shrb_shared_size(sdc_shrb_t *rb);
 int         sdc_shrb_reserved_size(sdc_shrb_t *rb);
 int         sdc_shrb_public_size(sdc_shrb_t *rb);
+uint64_t    sdc_shrb_probe(sdc_shrb_t *rb, int proc);
+void        sdc_shrb_probe_n(void *b, int *procs, int n, int *sizes);
 
 void        sdc_shrb_release(sdc_shrb_t *rb);
 void        sdc_shrb_release_all(sdc_shrb_t *rb);
 int         sdc_shrb_reacquire(sdc_shrb_t *rb);
 int         sdc_shrb_reclaim_space(sdc_shrb_t *rb);
+int         sdc_shrb_refill(sdc_shrb_t *rb);
 
 void        sdc_shrb_push_head(sdc_shrb_t *rb, int proc, void *e, int size);
 void        sdc_shrb_push_n_head(void *b, int proc, void *e, int n);
@@ -107,6 +191,8 @@ int         sdc_shrb_pop_head(void *b, int proc, void *buf);
 int         sdc_shrb_pop_tail(sdc_shrb_t *rb, int proc, void *buf);
 int         sdc_shrb_pop_n_tail(void *b, int proc, int n, void *buf, int steal_vol);
 int         sdc_shrb_try_pop_n_tail(void *b, int proc, int n, void *buf, int steal_vol);
+int         sdc_shrb_steal_n_tail(void *b, int proc, int n, int steal_vol);
+int         sdc_shrb_try_steal_n_tail(void *b, int proc, int n, int steal_vol);
 
 int         sdc_shrb_size(void *b);
 int         sdc_shrb_full(sdc_shrb_t *rb);
@@ -105,6 +105,7 @@ task_t *gtc_task_create(task_class_t tclass) {
 
   //task->affinity = 0; // Default values for header fields
   task->priority = 0;
+  task->cost     = 0;
 
   gtc_task_set_class(task, tclass);
 
@@ -159,6 +160,28 @@ task_class_t gtc_task_get_class(task_t *task) {
 
 
 
+/*
+ * Fold one execution time into the profile of its task class.  The moving average lets the
+ * estimate follow classes whose cost changes over the run.
+ */
+#define GTC_TASK_PROF_WEIGHT 8.0
+
+static void gtc_task_profile(tc_t *tc, task_class_t tclass, double ns) {
+  gtc_task_prof_t *prof = &tc->task_prof[tclass];
+
+  if (prof->ntasks++ == 0)
+    prof->est_ns = ns;
+  else
+    prof->est_ns += (ns - prof->est_ns) / GTC_TASK_PROF_WEIGHT;
+
+  if (tc->task_prof_ns == 0.0)
+    tc->task_prof_ns = ns;
+  else
+    tc->task_prof_ns += (ns - tc->task_prof_ns) / GTC_TASK_PROF_WEIGHT;
+}
+
+
+
 /**
  * Execute the given task in the context of the given tc
  *
@@ -172,8 +195,36 @@ void gtc_task_execute(gtc_t gtc, task_t *task) {
         task->task_class, task_class_reg[task->task_class].cb_execute);
   assert(task->task_class < task_class_count); // Ensure this is a valid callback handle
 
-  // Execute the task's callback on this tc and the task descriptor
-  task_class_reg[task->task_class].cb_execute(gtc, task);
+  // Execute the task's callback on this tc and the task descriptor, timing it when steal
+  // volumes are sized by work
+  if (tc->ldbal_cfg.steal_method == STEAL_WORK) {
+    task_class_t tclass = task->task_class; // the callback may reuse the descriptor
+    uint64_t     start  = gtc_get_tsctime();
+
+    task_class_reg[tclass].cb_execute(gtc, task);
+    gtc_task_profile(tc, tclass, (gtc_get_tsctime() - start) * 1000.0 / _c->tsc_cpu_hz);
+  } else {
+    task_class_reg[task->task_class].cb_execute(gtc, task);
+  }
   tc->ct.tasks_completed++;
   gtc_lprintf(DBGPROCESS, "  task completed\n");
 }
+
+
+
+/**
+ * Estimated execution time of a task, for sizing steals by work.  The task's cost hint wins,
+ * otherwise the task class profile is used, and classes that haven't run here yet cost the
+ * average over all tasks.  With nothing profiled every task costs the same.
+ *
+ * @param tc   task collection
+ * @param task task
+ * @return     estimated execution time in ns
+ */
+double gtc_task_cost(tc_t *tc, task_t *task) {
+  if (task->cost > 0)
+    return task->cost;
+  if (tc->task_prof[task->task_class].ntasks > 0)
+    return tc->task_prof[task->task_class].est_ns;
+  return (tc->task_prof_ns > 0.0) ? tc->task_prof_ns : 1.0;
+}
@@ -51,6 +51,12 @@ extern "C" {
 #define GTC_MAX_CHUNKS       10000
 #define GTC_MAX_CLOD_CLOS      100
 #define GTC_MAX_FNAMELEN      1024
+#define GTC_MAX_PRIORITIES       4
+#define GTC_MAX_PROBE_WIDTH     16
+
+// Words that other processes hit with atomics get a cache line to themselves
+#define GTC_CACHE_LINE          64
+#define GTC_CACHE_ALIGNED       __attribute__((aligned(GTC_CACHE_LINE)))
 
 #define GTC_USE_INTERNAL_TIMERS
 #define GTC_USE_TSC_TIMERS
@@ -134,7 +140,8 @@ extern "C" {
 struct task_s;
 struct saws_shrb_s;
 struct sdc_shrb_s;
-struct shrb_s;
+struct gtc_inbox_s;
+struct tc_s;
 
 // basic unit typedefs
 typedef int gtc_t;
@@ -145,8 +152,11 @@ typedef unsigned long tc_counter_t;
 // the list of registered tasks
 #define AUTO_BODY_SIZE -1
 
-enum target_select_e { TARGET_RANDOM, TARGET_ROUND_ROBIN };
-enum steal_method_e  { STEAL_HALF, STEAL_ALL, STEAL_CHUNK };
+enum target_select_e { TARGET_RANDOM, TARGET_ROUND_ROBIN, TARGET_XORSHIFT, TARGET_PERMUTATION,
+                       TARGET_STICKY, TARGET_TWO_CHOICE, TARGET_NPOLICIES };
+enum idle_mode_e     { IDLE_SPIN, IDLE_BACKOFF, IDLE_ADAPTIVE, IDLE_NMODES };
+enum victim_scope_e  { VICTIMS_ALL, VICTIMS_NODE, VICTIMS_REMOTE, VICTIMS_NSCOPES };
+enum steal_method_e  { STEAL_HALF, STEAL_ALL, STEAL_CHUNK, STEAL_WORK, STEAL_NMETHODS };
 enum tc_states { STATE_WORKING = 0, STATE_SEARCHING, STATE_STEALING, STATE_INACTIVE, STATE_TERMINATED };
 
 typedef struct {
@@ -159,6 +169,13 @@ typedef struct {
   int max_steal_attempts_remote; /* Max number of lock attempts before we "retry" a remote target. */
   int chunk_size;                /* Size of a steal when using STEAL_CHUNK */
   int local_search_factor;       /* Percent of steal attempts (0-100) that should target intra-node targets */
+  int idle_mode;                 /* One of idle_mode_e, what to do after a failed steal */
+  int idle_pause_max;            /* Cap on the exponential backoff, in pause instructions */
+  int idle_yield_after;          /* IDLE_ADAPTIVE: consecutive failed steals before we start yielding the CPU */
+  int idle_sleep_after;          /* IDLE_ADAPTIVE: consecutive failed steals before we start sleeping */
+  int idle_sleep_ns;             /* IDLE_ADAPTIVE: length of each sleep */
+  int lifeline_after;            /* Failed steals before we wait on our lifeline buddies instead of stealing, 0 disables lifelines */
+  int probe_width;               /* Victims probed at once before each steal (up to GTC_MAX_PROBE_WIDTH), 1 probes them one at a time */
 } gtc_ldbal_cfg_t;
 
 
@@ -180,6 +197,7 @@ struct task_s{
   task_class_t  task_class;
   int           created_by;
   int           priority;
+  uint32_t      cost;       // estimated execution time in ns for STEAL_WORK, 0 uses the task class profile
   char          body[0];
 };
 typedef struct task_s task_t;
@@ -191,10 +209,31 @@ typedef struct {
   int last_target;
 } gtc_vs_state_t;
 
+/** Execution time profile of one task class, kept by each process for STEAL_WORK.  */
+typedef struct {
+  uint64_t ntasks;   // tasks of this class executed here
+  double   est_ns;   // moving average of their execution time
+} gtc_task_prof_t;
+
+/** Idle state for one search, initialize to 0.  */
+typedef struct {
+  int nfails;       // consecutive failed steals
+  int npause;       // current backoff, in pause instructions
+} gtc_idle_state_t;
+
+/** Candidate steal victims, target selection policies pick one of pes[0..n-1] */
+typedef struct {
+  int  *pes;         // candidate PEs, never includes ourselves
+  int   n;
+  int   next;        // round-robin and permutation cursor
+  int   scope;       // one of victim_scope_e
+} gtc_victim_set_t;
+
 /** queue implementation type */
 enum gtc_qtype_e {
   GtcQueueSDC,
-  GtcQueueSAWS
+  GtcQueueSAWS,
+  GtcQueueSDCLF   // split deferred-copy with lock-free (CAS) steal reservation
 };
 typedef enum gtc_qtype_e gtc_qtype_t;
 
@@ -243,11 +282,15 @@ struct tc_timers_s {
   tc_timer_t ensure;
   tc_timer_t release;
   tc_timer_t reacquire;
+  tc_timer_t reacqwait;
+  tc_timer_t reacqdefer;
   tc_timer_t pushhead;
   tc_timer_t poptail;
   tc_timer_t getsteal;
   tc_timer_t getfail;
   tc_timer_t getmeta;
+  tc_timer_t stealdone;
+  tc_timer_t backoff;
   tc_timer_t t[5]; // general purpose
 };
 typedef struct tc_timers_s tc_timers_t;
@@ -258,6 +301,8 @@ struct tc_counters_s {
   tc_counter_t         tasks_completed;           // Number of tasks processed by this thread
   tc_counter_t         tasks_stolen;              // Number of tasks stolen by this thread
   tc_counter_t         num_steals;                // Number of successful steals
+  tc_counter_t         tasks_stolen_local;        // Number of tasks stolen from on-node victims
+  tc_counter_t         num_steals_local;          // Number of successful steals from on-node victims
   tc_counter_t         failed_steals_locked;      // # steal attempts that failed after locking
   tc_counter_t         failed_steals_unlocked;    // # steal attempts that failed before locking
   tc_counter_t         aborted_steals;            // # steal attempts that were aborted due to contention
@@ -266,6 +311,15 @@ struct tc_counters_s {
   tc_counter_t         dispersion_attempts_unlocked; // failed_steals_unlocked during dispersion
   tc_counter_t         getcalls;                  // # of calls to get_buf
   tc_counter_t         getlocal;                  // # of calls resulting in local work found
+  tc_counter_t         idle_yields;               // # times we yielded the CPU after failed steals
+  tc_counter_t         idle_sleeps;               // # times we slept after failed steals
+  tc_counter_t         lifeline_waits;            // # times we stopped stealing and waited on our lifelines
+  tc_counter_t         lifeline_pushes;           // # times we pushed work to a buddy waiting on us
+  tc_counter_t         lifeline_tasks;            // # tasks pushed to buddies waiting on us
+  tc_counter_t         probes;                    // # victims probed by multi-victim probing
+  tc_counter_t         probe_rounds;              // # rounds of parallel probes
+  tc_counter_t         prio_tasks[GTC_MAX_PRIORITIES];  // # tasks taken from each priority level
+  tc_counter_t         prio_stolen[GTC_MAX_PRIORITIES]; // # tasks stolen from each priority level
 };
 typedef struct tc_counters_s tc_counters_t;
 
@@ -292,12 +346,18 @@ struct tqrbi_s {
   int      (*pop_head)(void *b, int proc, void *buf);
   int      (*pop_n_tail)(void *b, int proc, int n, void *e, int steal_vol);
   int      (*try_pop_n_tail)(void *b, int proc, int n, void *buf, int steal_vol);
+  int      (*steal_n_tail)(void *b, int proc, int n, int steal_vol);
+  int      (*try_steal_n_tail)(void *b, int proc, int n, int steal_vol);
   void     (*push_n_head)(void *b, int proc, void *e, int size);
   int      (*work_avail)(void *b);
+  void     (*probe_n)(void *b, int *procs, int n, int *sizes);
 };
 typedef struct tqrbi_s tqrbi_t;
 
 
+typedef int (*gtc_victim_policy_t)(struct tc_s *tc, gtc_victim_set_t *set);
+
+
 /*
  * SAWS Task Collection
  */
@@ -307,17 +367,29 @@ struct tc_s {
   gtc_qtype_t         qtype;                      // type discriminator for queue implementation
   size_t              qsize;                      // used for common allocations, clears
   int                 valid;                      // in use flag
-  void               *steal_buf;                  // buffer for performing steals (allocation not on crit path)
   int                 chunk_size;                 // number of tasks we can steal at a time
   int                 max_body_size;
   int                 last_target;                // Global round robin -- remember our last target
 
   gtc_ldbal_cfg_t     ldbal_cfg;                  // load balancer configuration
+  gtc_victim_policy_t select_victim;              // target selection policy, set from ldbal_cfg
+  gtc_victim_set_t    victims[VICTIMS_NSCOPES];   // all other PEs, those on our node (SHMEM_TEAM_SHARED), and the rest
+  uint8_t            *on_node;                    // on_node[p] is set when PE p is on our node
+  int                *victim_load;                // last shared queue size seen on each PE
+  int                 sticky_victim;              // last PE we stole from, until it runs dry
+  uint64_t            victim_rand;                // xorshift state for target selection
+  uint64_t            lifelines;                  // (remote) bit i is set while the hypercube buddy across dimension i waits on us
+  int                 nlifelines;                 // hypercube dimensions, our buddies are rank ^ (1 << i)
+  task_t             *lifeline_buf;               // (private) scratch task for pushing work to buddies
+  gtc_task_prof_t     task_prof[GTC_MAX_TASK_CLASSES]; // execution time profile of each task class
+  double              task_prof_ns;               // moving average over all classes, the cost of classes not seen yet
 
   td_t               *td;                         // termination detection data
 
-  void               *shared_rb;                  // ring buffer for task queue
-  struct shrb_s      *inbox;                      // task inbox
+  void               *shared_rb;                  // ring buffer for task queue (priority level 0)
+  void               *prio_rb[GTC_MAX_PRIORITIES]; // ring buffer for each priority level, prio_rb[0] == shared_rb
+  int                 npriorities;                // number of priority levels in use, set with GTC_PRIORITIES
+  struct gtc_inbox_s *inbox;                      // task inbox, receives remote adds
   // STATISTICS:
   tc_timers_t          *timers;                    // TSC timers used for internal performance monitoring
   tc_counters_t        ct;                         // perf/stat counters
@@ -332,6 +404,12 @@ struct tc_s {
 };
 typedef struct tc_s tc_t;
 
+/* priority level a task is queued at, higher levels are taken and stolen first */
+static inline int gtc_task_level(tc_t *tc, task_t *task) {
+  if (task->priority <= 0) return 0;
+  return task->priority < tc->npriorities ? task->priority : tc->npriorities - 1;
+}
+
 
 /*
  * SAWS global context
@@ -367,8 +445,9 @@ typedef enum gtc_status_e gtc_status_t;
 // Global variables
 extern gtc_context_t *_c;
 extern int gtc_is_initialized;
-extern char *target_methods[2];
-extern char *steal_methods[3];
+extern char *target_methods[TARGET_NPOLICIES];
+extern char *idle_modes[IDLE_NMODES];
+extern char *steal_methods[STEAL_NMETHODS];
 extern int __gtc_marker[5];
 
 
@@ -398,13 +477,15 @@ char   *gtc_queue_name(gtc_t gtc);
 
 void    gtc_progress(gtc_t gtc);
 int     gtc_add(gtc_t gtc, task_t *task, int proc);
+int     gtc_scatter(gtc_t gtc, task_t **tasks, int ntasks);
 int     gtc_tasks_avail(gtc_t gtc);
 void    gtc_enable_stealing(gtc_t gtc);
 void    gtc_disable_stealing(gtc_t gtc);
 int     gtc_get_local_buf(gtc_t gtc, int priority, task_t *buf);
-int     gtc_steal_tail(gtc_t gtc, int target);
-int     gtc_try_steal_tail(gtc_t gtc, int target);
+int     gtc_steal_tail(gtc_t gtc, int target, int level);
+int     gtc_try_steal_tail(gtc_t gtc, int target, int level);
 int     gtc_select_target(gtc_t gtc, gtc_vs_state_t *state);
+void    gtc_idle_wait(gtc_t gtc, gtc_idle_state_t *idle);
 task_t *gtc_get(gtc_t gtc, int priority);
 void    gtc_set_external_work_avail(gtc_t gtc, int flag);
 task_t *gtc_task_inplace_create_and_add(gtc_t gtc, task_class_t tclass);
@@ -425,12 +506,14 @@ void               gtc_task_destroy(task_t *task);
 void               gtc_task_reuse(task_t *task);
 #define            gtc_task_set_priority(_TASK, _PRIORITY) (_TASK)->priority = (_PRIORITY)
 #define            gtc_task_set_affinity(_TASK, _AFFINITY) (_TASK)->affinity = (_AFFINITY)
+#define            gtc_task_set_cost(_TASK, _NS) (_TASK)->cost = (_NS)
 void               gtc_task_set_class(task_t *task, task_class_t tclass);
 task_class_t       gtc_task_get_class(task_t *task);
 int                gtc_task_class_largest_body_size(void);
 task_class_desc_t *gtc_task_class_lookup(task_class_t tclass);
 #define            gtc_task_body_size(TSK) gtc_task_class_lookup((TSK)->task_class)->body_size
 void               gtc_task_execute(gtc_t gtc, task_t *task);
+double             gtc_task_cost(tc_t *tc, task_t *task);
 #define            gtc_task_body(TSK) (&((TSK)->body))
 
 //util.c
@@ -440,12 +523,31 @@ int                gtc_dbg_printf(const char *format, ...);
 int                gtc_lvl_dbg_printf(int lvl, const char *format, ...);
 int                gtc_lvl_dbg_eprintf(int lvl, const char *format, ...);
 double             gtc_tsc_calibrate(void);
+int                gtc_map_peers(void *sym, void **peers);
+
+// victim.c
+void                gtc_victims_create(tc_t *tc);
+void                gtc_victims_destroy(tc_t *tc);
+void                gtc_victims_reset(tc_t *tc);
+gtc_victim_policy_t gtc_victim_policy(int target_selection);
+int                 gtc_victim_coin(tc_t *tc, int pct);
+void                gtc_victim_observe(tc_t *tc, int v, int size);
+void                gtc_victim_stolen(tc_t *tc, int v, int nstolen);
+int                 gtc_probe_victims(gtc_t gtc, gtc_vs_state_t *state, int *level, int *size);
+
+// lifeline.c
+void    gtc_lifelines_create(tc_t *tc);
+void    gtc_lifelines_destroy(tc_t *tc);
+void    gtc_lifelines_reset(tc_t *tc);
+void    gtc_lifeline_register(gtc_t gtc);
+void    gtc_lifeline_push(gtc_t gtc);
 
 // collection-sdc.c
 gtc_t   gtc_create_sdc(gtc_t gtc, int max_body_size, int shrb_size, gtc_ldbal_cfg_t *ldbal_cfg);
 void    gtc_destroy_sdc(gtc_t gtc);
 void    gtc_reset_sdc(gtc_t gtc);
 char   *gtc_queue_name_sdc();
+char   *gtc_queue_name_sdclf();
 void    gtc_progress_sdc();
 int     gtc_tasks_avail_sdc(gtc_t gtc);
 int     gtc_get_buf_sdc(gtc_t, int priority, task_t *buf);
@@ -537,6 +639,17 @@ static inline void *gtc_shmem_malloc(size_t size) {
   return shmem_malloc(size);
 }
 
+/**
+ * gtc_shmem_align - wrapper for shmem_align
+ */
+static inline void *gtc_shmem_align(size_t align, size_t size) {
+#ifdef SCIOTO_TRACING
+  gtc_lprintf(DBGMEM, "gtc_shmem_align: %s of %d\n", _c->curfun, size);
+#endif
+  _c->shmallocsize += size;
+  return shmem_align(align, size);
+}
+
 /**
  * gtc_calloc - wrapper for shmem_calloc
  */
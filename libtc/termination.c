@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <strings.h>
 #include <assert.h>
 #include <shmem.h>
 
@@ -13,10 +14,16 @@
 /** Static function prototypes **/
 
 static void token_reset(td_token_t *t);
+static void token_send(td_t *td, td_token_t *dest, uint64_t *voted, int proc);
+static void token_send_complete(td_t *td);
+static uint64_t vote_fetch(td_t *td, int slot);
 
 static void pass_token_up(td_t *td);
 static void pass_token_down(td_t *td);
 
+static void tree_place(int i, int n, int k, int *parent, int *slot, int *kids);
+static void tree_build(td_t *td);
+
 
 /** Token Manipulation Functions **/
 
@@ -26,7 +33,7 @@ static void pass_token_down(td_t *td);
   * @param[in] count1 New value for counter 1.
   * @param[in] count2 New value for counter 2.
   */
-void td_set_counters(td_t *td, int count1, int count2) {
+void td_set_counters(td_t *td, uint64_t count1, uint64_t count2) {
   GTC_ENTRY();
   td->token.spawned = count1;
   td->token.completed = count2;
@@ -45,33 +52,78 @@ static void token_reset(td_token_t *t) {
 /** Communication Functions -- Move the token up and down the tree **/
 
 /**
- * pass_token_down - broadcast global termination status
- * @param td termination detection state
+ * token_send - put send_token into dest on proc and count a vote in proc's voted counter.
+ *   In event mode this is one signaled non-blocking put, completed lazily by
+ *   token_send_complete() before send_token is overwritten.
+ * @param td    termination detection state
+ * @param dest  token slot on proc
+ * @param voted vote counter on proc
+ * @param proc  receiving process
  */
-static void pass_token_down(td_t *td) {
-  GTC_ENTRY();
-  gtc_lprintf(DBGTD, "td: passing token down: send_token: [ %s %d %d ] last : s: %d c: %d nkids: %d l: %d r: %d\n",
-      td->send_token.state == ACTIVE ? "a" : "t", td->send_token.spawned, td->send_token.completed,
-      td->last_spawned, td->last_completed, td->nchildren, td->l, td->r);
+static void token_send(td_t *td, td_token_t *dest, uint64_t *voted, int proc) {
+  if (td->mode == TD_EVENT) {
+    shmem_putmem_signal_nbi(dest, &td->send_token, sizeof(td_token_t), voted, 1, SHMEM_SIGNAL_ADD, proc);
+    td->send_pending = 1;
+    return;
+  }
 
-  if (td->nchildren > 0) {
 #if GTC_USE_SIGNAL_COMMS
-    shmem_putmem_signal_nbi(&td->down_token, &td->send_token, sizeof(td_token_t), &td->parent_voted, 1, SHMEM_SIGNAL_ADD, td->l);
+  shmem_putmem_signal_nbi(dest, &td->send_token, sizeof(td_token_t), voted, 1, SHMEM_SIGNAL_ADD, proc);
 #else
-    shmem_putmem(&td->down_token, &td->send_token, sizeof(td_token_t), td->l);
-    shmem_atomic_inc(&td->parent_voted, td->l);
+  shmem_putmem(dest, &td->send_token, sizeof(td_token_t), proc);
+  shmem_atomic_inc(voted, proc);
 #endif // GTC_USE_SIGNAL_COMMS
+}
+
+
+
+/**
+ * token_send_complete - wait for outstanding non-blocking token puts, send_token can be
+ *   reused afterwards
+ * @param td termination detection state
+ */
+static void token_send_complete(td_t *td) {
+  if (td->send_pending) {
+    shmem_quiet();
+    td->send_pending = 0;
+  }
+}
+
+
+
+/**
+ * vote_fetch - read one of our vote counters
+ * @param td   termination detection state
+ * @param slot child slot, TD_VOTE_PARENT, or TD_VOTE_WAKEUP
+ */
+static uint64_t vote_fetch(td_t *td, int slot) {
+  if (td->mode == TD_EVENT)
+    return shmem_signal_fetch(&td->voted[slot]);
 
-    if (td->nchildren == 2) {
 #if GTC_USE_SIGNAL_COMMS
-      shmem_putmem_signal_nbi(&td->down_token, &td->send_token, sizeof(td_token_t), &td->parent_voted, 1, SHMEM_SIGNAL_ADD, td->r);
+  return shmem_signal_fetch(&td->voted[slot]);
 #else
-      shmem_putmem(&td->down_token, &td->send_token, sizeof(td_token_t), td->r);
-      shmem_atomic_inc(&td->parent_voted, td->r);
+  return shmem_atomic_fetch(&td->voted[slot], td->procid);
 #endif // GTC_USE_SIGNAL_COMMS
-    }
-  }
-  shmem_quiet();
+}
+
+
+
+/**
+ * pass_token_down - broadcast global termination status
+ * @param td termination detection state
+ */
+static void pass_token_down(td_t *td) {
+  GTC_ENTRY();
+  gtc_lprintf(DBGTD, "td: passing token down: send_token: [ %s %lu %lu ] last : s: %lu c: %lu nkids: %d\n",
+      td->send_token.state == ACTIVE ? "a" : "t", td->send_token.spawned, td->send_token.completed,
+      td->last_spawned, td->last_completed, td->nchildren);
+
+  for (int s = 0; s < TD_MAX_CHILDREN; s++)
+    if (td->children[s] >= 0)
+      token_send(td, &td->down_token, &td->voted[TD_VOTE_PARENT], td->children[s]);
+  if (td->mode == TD_POLL)
+    shmem_quiet();
   td->num_cycles++;
   GTC_EXIT();
 }
@@ -84,56 +136,135 @@ static void pass_token_down(td_t *td) {
  */
 static void pass_token_up(td_t *td) {
   GTC_ENTRY();
-  gtc_lprintf(DBGTD, "td: passing token up: send_token: [ %s %d %d ] last : s: %d c: %d\n",
+  gtc_lprintf(DBGTD, "td: passing token up: send_token: [ %s %lu %lu ] last : s: %lu c: %lu\n",
       td->send_token.state == ACTIVE ? "a" : "t", td->send_token.spawned, td->send_token.completed,
       td->last_spawned, td->last_completed);
 
-  if ((td->procid % 2) == 1) {
-#if GTC_USE_SIGNAL_COMMS
-      shmem_putmem_signal_nbi(&td->upleft_token, &td->send_token, sizeof(td_token_t), &td->left_voted, 1, SHMEM_SIGNAL_ADD, td->p);
-#else
-      shmem_putmem(&td->upleft_token, &td->send_token, sizeof(td_token_t), td->p);
-      shmem_atomic_inc(&td->left_voted, td->p);
-#endif // GTC_USE_SIGNAL_COMMS
+  token_send(td, &td->up_tokens[td->slot], &td->voted[td->slot], td->p);
+  if (td->mode == TD_POLL)
+    shmem_quiet();
+  GTC_EXIT();
+}
+
+
+
+/**
+ * tree_place - place position i of n in a k-ary heap
+ * @param i      position
+ * @param n      number of positions
+ * @param k      fan-out
+ * @param parent set to the parent's position, -1 at the root
+ * @param slot   set to our child slot on the parent
+ * @param kids   set to the k child positions, -1 if none
+ */
+static void tree_place(int i, int n, int k, int *parent, int *slot, int *kids) {
+  *parent = (i > 0) ? (i - 1) / k : -1;
+  *slot   = (i > 0) ? (i - 1) % k : 0;
+  for (int c = 0; c < k; c++)
+    kids[c] = (i*k + 1 + c < n) ? i*k + 1 + c : -1;
+}
+
+
+
+/**
+ * tree_build - lay out the termination tree.  The flat tree is a k-ary heap over all PEs.
+ *   The node-aware tree is a k-ary heap over the PEs of each node rooted at the node
+ *   leader, its first PE, and a k-ary heap over the leaders in PE order, so only leaders
+ *   vote across nodes.  PE 0 is the root of both.  Collective.
+ * @param td termination detection state
+ */
+static void tree_build(td_t *td) {
+  GTC_ENTRY();
+  int k = td->arity, parent, slot, kids[TD_MAX_ARITY];
+  int nnode = shmem_team_n_pes(SHMEM_TEAM_SHARED);
+
+  for (int s = 0; s < TD_MAX_CHILDREN; s++)
+    td->children[s] = -1;
+
+  if (!td->node_aware || nnode <= 0 || nnode == td->nproc) {
+    tree_place(td->procid, td->nproc, k, &td->p, &td->slot, td->children);
+
   } else {
-#if GTC_USE_SIGNAL_COMMS
-      shmem_putmem_signal_nbi(&td->upright_token, &td->send_token, sizeof(td_token_t), &td->right_voted, 1, SHMEM_SIGNAL_ADD, td->p);
-#else
-      shmem_putmem(&td->upright_token, &td->send_token, sizeof(td_token_t), td->p);
-      shmem_atomic_inc(&td->right_voted, td->p);
-#endif // GTC_USE_SIGNAL_COMMS
+    int  me = shmem_team_my_pe(SHMEM_TEAM_SHARED);
+    int *leaders = gtc_shmem_calloc(2*td->nproc, sizeof(int));
+
+    tree_place(me, nnode, k, &parent, &td->slot, kids);
+    td->p = (parent >= 0) ? shmem_team_translate_pe(SHMEM_TEAM_SHARED, parent, SHMEM_TEAM_WORLD) : -1;
+    for (int c = 0; c < k; c++)
+      if (kids[c] >= 0)
+        td->children[c] = shmem_team_translate_pe(SHMEM_TEAM_SHARED, kids[c], SHMEM_TEAM_WORLD);
+
+    // find the leaders, then place ours in the inter-node tree
+    leaders[td->nproc + td->procid] = (me == 0);
+    shmem_sum_reduce(SHMEM_TEAM_WORLD, leaders, leaders + td->nproc, td->nproc);
+
+    if (me == 0) {
+      int nleaders = 0, idx = 0;
+
+      for (int i = 0; i < td->nproc; i++) {
+        if (leaders[i]) {
+          if (i == td->procid)
+            idx = nleaders;
+          leaders[nleaders++] = i;
+        }
+      }
+
+      tree_place(idx, nleaders, k, &parent, &slot, kids);
+      td->p    = (parent >= 0) ? leaders[parent] : -1;
+      td->slot = k + slot;
+      for (int c = 0; c < k; c++)
+        if (kids[c] >= 0)
+          td->children[k + c] = leaders[kids[c]];
+    }
+
+    shmem_free(leaders);
   }
-  shmem_quiet();
+
+  td->nchildren = 0;
+  for (int s = 0; s < TD_MAX_CHILDREN; s++)
+    if (td->children[s] >= 0)
+      td->nchildren++;
   GTC_EXIT();
 }
 
 
 
-/** Create a termination detection context.
+/** Create a termination detection context.  GTC_TD_MODE=event passes tokens with
+  * signaled non-blocking puts and lets idle processes block in td_wait(), the default
+  * (poll) uses blocking puts and td_wait() returns immediately.  Event mode needs the
+  * OpenSHMEM 1.5 signal and wait_until_any_vector routines.  GTC_TD_ARITY sets the
+  * tree fan-out (default 2) and GTC_TD_TREE=flat turns off the node-aware layout.
   *
   * @return         Termination detection context.
   */
 td_t *td_create() {
   GTC_ENTRY();
   td_t *td = gtc_shmem_malloc(sizeof(td_t));
+  char *envp;
 
   assert(td != NULL);
 
   td->nproc = shmem_n_pes();
   td->procid = shmem_my_pe();
 
-  td->p = ((td->procid + 1) >> 1) - 1;
-  td->l = ((td->procid + 1) << 1) - 1;
-  td->r = td->l + 1;
+  td->mode = TD_POLL;
+  if ((envp = getenv("GTC_TD_MODE")) != NULL && strcasecmp(envp, "event") == 0)
+    td->mode = TD_EVENT;
 
-  td->nchildren = 0;
-  if (td->l < td->nproc) td->nchildren++;
-  if (td->r < td->nproc) td->nchildren++;
+  td->arity = 2;
+  if ((envp = getenv("GTC_TD_ARITY")) != NULL)
+    td->arity = atoi(envp);
+  assert(td->arity >= 2 && td->arity <= TD_MAX_ARITY);
+
+  td->node_aware = 1;
+  if ((envp = getenv("GTC_TD_TREE")) != NULL && strcasecmp(envp, "flat") == 0)
+    td->node_aware = 0;
 
+  tree_build(td);
   td_reset(td);
 
-  gtc_lprintf(DBGTD,"TD Created (%d of %d): parent=%d, left_child=%d, right_child=%d, direction=%s\n",
-      td->procid, td->nproc, td->p, td->l, td->r, td->token_direction == UP ? "UP" : "DOWN");
+  gtc_lprintf(DBGTD,"TD Created (%d of %d): parent=%d, slot=%d, nchildren=%d, arity=%d, direction=%s\n",
+      td->procid, td->nproc, td->p, td->slot, td->nchildren, td->arity, td->token_direction == UP ? "UP" : "DOWN");
 
   GTC_EXIT(td);
 }
@@ -149,25 +280,24 @@ void td_reset(td_t *td) {
   shmem_barrier_all();
 
   token_reset(&td->token);
-  token_reset(&td->upleft_token);
-  token_reset(&td->upright_token);
+  for (int s = 0; s < TD_MAX_CHILDREN; s++)
+    token_reset(&td->up_tokens[s]);
   token_reset(&td->down_token);
   token_reset(&td->send_token);
 
   td->num_cycles   = 0;
   td->num_attempts = 0;
+  td->num_waits    = 0;
+  td->send_pending = 0;
 
-  td->parent_voted = 0;
-  td->left_voted   = 0;
-  td->right_voted  = 0;
+  for (int s = 0; s < TD_NVOTES; s++) {
+    td->voted[s]      = 0;
+    td->last_voted[s] = 0;
+  }
 
   td->last_spawned = 0;
   td->last_completed = 0;
 
-  td->last_left = 0;
-  td->last_right = 0;
-  td->last_parent = 0;
-
   td->token_direction = UP;
 
   shmem_barrier_all();
@@ -195,7 +325,7 @@ void td_destroy(td_t *td) {
   */
 int td_attempt_vote(td_t *td) {
   GTC_ENTRY();
-  uint64_t nleft, nright, ndown;
+  uint64_t votes[TD_NVOTES];
   int have_votes;
   // Special Case: 1 Thread
   if (td->nproc == 1) {
@@ -210,24 +340,21 @@ int td_attempt_vote(td_t *td) {
     td->last_completed = td->token.completed;
     return td->token.state == TERMINATED ? 1 : 0;
   }
-#if GTC_USE_SIGNAL_COMMS
-  nleft  = shmem_signal_fetch(&td->left_voted);
-  nright = shmem_signal_fetch(&td->right_voted);
-  ndown  = shmem_signal_fetch(&td->parent_voted);
-#else
-  nleft  = shmem_atomic_fetch(&td->left_voted, td->procid);
-  nright = shmem_atomic_fetch(&td->right_voted, td->procid);
-  ndown  = shmem_atomic_fetch(&td->parent_voted, td->procid);
-#endif // GTC_USE_SIGNAL_COMMS
-  shmem_quiet();
-  gtc_lprintf(DBGTD, "td_attempt_vote: %s nl: %d nr: %d nd: %d last-l: %d last-r: %d last-p: %d\n",
-      td->token_direction == UP ? "UP" : "DOWN", nleft, nright, ndown,
-      td->last_left, td->last_right, td->last_parent);
+  for (int s = 0; s < TD_MAX_CHILDREN; s++)
+    if (td->children[s] >= 0)
+      votes[s] = vote_fetch(td, s);
+  votes[TD_VOTE_PARENT] = vote_fetch(td, TD_VOTE_PARENT);
+  if (td->mode == TD_POLL)
+    shmem_quiet();
+
+  gtc_lprintf(DBGTD, "td_attempt_vote: %s nd: %lu last-p: %lu nkids: %d\n",
+      td->token_direction == UP ? "UP" : "DOWN", votes[TD_VOTE_PARENT], td->last_voted[TD_VOTE_PARENT],
+      td->nchildren);
 
   // Case 1: Token is moving down the tree
   if (td->token_direction == DOWN) {
     // have we received a vote from the parent?
-    if ((td->procid == 0) || (ndown > td->last_parent)) {
+    if ((td->p < 0) || (votes[TD_VOTE_PARENT] > td->last_voted[TD_VOTE_PARENT])) {
       if (td->nchildren == 0) {
         // leaf
         if (td->down_token.state == TERMINATED) {
@@ -235,49 +362,49 @@ int td_attempt_vote(td_t *td) {
         } else {
           // restart reduction
           gtc_lprintf(DBGTD, "td_attempt_vote: restarting vote\n");
+          token_send_complete(td);
           td->send_token = td->token;
           pass_token_up(td);
-          td->last_parent = ndown;
+          td->last_voted[TD_VOTE_PARENT] = votes[TD_VOTE_PARENT];
         }
       } else {
         // interior node
         gtc_lprintf(DBGTD, "td_attempt_vote: casting downward votes\n");
         if (td->down_token.state == TERMINATED)
           td->token.state = TERMINATED;
+        token_send_complete(td);
         td->send_token = td->down_token; // struct copy
         pass_token_down(td);
         td->token_direction = UP;
 
         if (td->down_token.state != TERMINATED) {
           // expect another vote from parent
-          td->last_parent = ndown;
+          td->last_voted[TD_VOTE_PARENT] = votes[TD_VOTE_PARENT];
         }
       }
     }
 
   } else {
-    // if we've received votes from left and right:
-    have_votes = 0;
-    switch (td->nchildren) {
-      case 0:
-        have_votes = 1;
-        break;
-      case 1:
-        if (nleft > td->last_left)
-          have_votes = 1;
-        break;
-      case 2:
-        if ((nleft > td->last_left) && (nright > td->last_right))
-          have_votes = 1;
-        break;
-    }
+    // if we've received votes from all of our children:
+    have_votes = 1;
+    for (int s = 0; s < TD_MAX_CHILDREN; s++)
+      if (td->children[s] >= 0 && votes[s] <= td->last_voted[s])
+        have_votes = 0;
 
     if (have_votes) {
-      int spawned   = td->token.spawned   + td->upleft_token.spawned   + td->upright_token.spawned;
-      int completed = td->token.completed + td->upleft_token.completed + td->upright_token.completed;
+      uint64_t spawned   = td->token.spawned;
+      uint64_t completed = td->token.completed;
+
+      token_send_complete(td);
+      for (int s = 0; s < TD_MAX_CHILDREN; s++) {
+        if (td->children[s] >= 0) {
+          spawned   += td->up_tokens[s].spawned;
+          completed += td->up_tokens[s].completed;
+        }
+      }
 
       // if root
-      if (td->procid == 0) {
+      if (td->p < 0) {
 
         td->num_attempts++; // track termination attempts
 
@@ -288,10 +415,8 @@ int td_attempt_vote(td_t *td) {
         td->last_spawned   = spawned;
         td->last_completed = completed;
 
-        gtc_lprintf(DBGTD, "td_attempt_vote: broadcasting termination state : token: %d %d ul: %d %d ur: %d %d\n",
-            td->token.spawned, td->token.completed,
-            td->upleft_token.spawned, td->upleft_token.completed,
-            td->upright_token.spawned, td->upright_token.completed);
+        gtc_lprintf(DBGTD, "td_attempt_vote: broadcasting termination state : token: %lu %lu total: %lu %lu\n",
+            td->token.spawned, td->token.completed, spawned, completed);
         td->send_token.state     = td->token.state;
         td->send_token.spawned   = spawned;
         td->send_token.completed = completed;
@@ -310,8 +435,9 @@ int td_attempt_vote(td_t *td) {
       }
 
       if (td->token.state != TERMINATED) {
-        td->last_left  = nleft;
-        td->last_right = nright;
+        for (int s = 0; s < TD_MAX_CHILDREN; s++)
+          if (td->children[s] >= 0)
+            td->last_voted[s] = votes[s];
       }
     }
   }
@@ -321,3 +447,73 @@ int td_attempt_vote(td_t *td) {
   }
   GTC_EXIT(td->token.state == TERMINATED ? 1 : 0);
 }
+
+
+
+/** Block until td_attempt_vote() can make progress: a vote this process is waiting on
+  * arrives, or another process calls td_wake() on it.  Only blocks in event mode, and
+  * never once termination has been detected.
+  *
+  * @param[in] td Termination detection context.
+  */
+void td_wait(td_t *td) {
+  GTC_ENTRY();
+  uint64_t vals[TD_NVOTES];
+  int      skip[TD_NVOTES], nwait = 0;
+
+  if (td->mode != TD_EVENT || td->nproc == 1 || td->token.state == TERMINATED)
+    GTC_EXIT();
+
+  for (int s = 0; s < TD_NVOTES; s++) {
+    vals[s] = td->last_voted[s];
+    skip[s] = 1;
+  }
+  skip[TD_VOTE_WAKEUP] = 0;
+
+  // wait only on votes that haven't arrived yet, same tests as td_attempt_vote()
+  if (td->token_direction == DOWN) {
+    if (td->p < 0 || shmem_signal_fetch(&td->voted[TD_VOTE_PARENT]) > td->last_voted[TD_VOTE_PARENT])
+      GTC_EXIT();
+    skip[TD_VOTE_PARENT] = 0;
+    nwait++;
+
+  } else {
+    for (int s = 0; s < TD_MAX_CHILDREN; s++) {
+      if (td->children[s] >= 0 && shmem_signal_fetch(&td->voted[s]) == td->last_voted[s]) {
+        skip[s] = 0;
+        nwait++;
+      }
+    }
+  }
+
+  if (nwait == 0)
+    GTC_EXIT();
+
+  // our own vote has to be on its way before we go to sleep
+  token_send_complete(td);
+  td->num_waits++;
+
+  gtc_lprintf(DBGTD, "td_wait: %s blocking on %d votes\n", td->token_direction == UP ? "UP" : "DOWN", nwait);
+
+  shmem_uint64_wait_until_any_vector(td->voted, TD_NVOTES, skip, SHMEM_CMP_GT, vals);
+
+  td->last_voted[TD_VOTE_WAKEUP] = shmem_atomic_fetch(&td->voted[TD_VOTE_WAKEUP], td->procid);
+  GTC_EXIT();
+}
+
+
+
+/** Wake a process blocked in td_wait(), e.g. after pushing work to it.  Does nothing
+  * outside of event mode.
+  *
+  * @param[in] td   Termination detection context.
+  * @param[in] proc Process to wake.
+  */
+void td_wake(td_t *td, int proc) {
+  GTC_ENTRY();
+  if (td->mode == TD_EVENT) {
+    shmem_fence(); // the caller's earlier puts to proc land first
+    shmem_atomic_inc(&td->voted[TD_VOTE_WAKEUP], proc);
+  }
+  GTC_EXIT();
+}
@@ -6,40 +6,49 @@
 
 enum token_states { ACTIVE, TERMINATED };
 enum token_directions { UP, DOWN };
+enum td_modes { TD_POLL, TD_EVENT };  // set with GTC_TD_MODE=poll|event
+
+#define TD_MAX_ARITY    8                  // largest tree fan-out, set with GTC_TD_ARITY
+#define TD_MAX_CHILDREN (2*TD_MAX_ARITY)   // node leaders have on-node and off-node children
+
+// vote counter slots: one per child slot, then the parent and td_wake()
+#define TD_VOTE_PARENT  TD_MAX_CHILDREN
+#define TD_VOTE_WAKEUP  (TD_MAX_CHILDREN+1)
+#define TD_NVOTES       (TD_MAX_CHILDREN+2)
 
 typedef struct {
-  int  state;
-  int  spawned;   // counter1
-  int  completed; // counter2
+  int       state;
+  uint64_t  spawned;   // counter1
+  uint64_t  completed; // counter2
 } td_token_t;
 
 struct td_s {
   int procid, nproc;
-  int p;                  // parent rank
-  int l;                  // left child rank
-  int r;                  // right child rank
+  int arity;              // tree fan-out
+  int node_aware;         // on-node PEs aggregate under a node leader first
+  int p;                  // parent rank, -1 at the root
+  int slot;               // our child slot on the parent
+  int children[TD_MAX_CHILDREN]; // child ranks by slot, -1 if none.  Leaders use slots
+                                 // arity.. for their off-node children
   int nchildren;          // number of children
   int num_cycles;
   int num_attempts;       // number of failed termination attempts
   int have_voted;
+  int num_waits;          // number of times td_wait() blocked
+  int send_pending;       // non-blocking token put not yet completed
+  enum td_modes mode;
   enum token_directions token_direction;
 
   td_token_t token;
   td_token_t down_token;
-  td_token_t upleft_token;
-  td_token_t upright_token;
+  td_token_t up_tokens[TD_MAX_CHILDREN];
   td_token_t send_token;
 
-  uint64_t   left_voted;  // signal counters for OpenSHMEM signal puts
-  uint64_t   right_voted;
-  uint64_t   parent_voted;
-
-  uint64_t   last_left;   // last observed signal values
-  uint64_t   last_right;
-  uint64_t   last_parent;
+  uint64_t   voted[TD_NVOTES];      // signal counters for OpenSHMEM signal puts
+  uint64_t   last_voted[TD_NVOTES]; // last observed signal values
 
-  int last_spawned;
-  int last_completed;
+  uint64_t   last_spawned;
+  uint64_t   last_completed;
 
 };
 typedef struct td_s td_t;
@@ -49,8 +58,10 @@ void  td_destroy(td_t *td);
 void  td_reset(td_t *td);
 
 int   td_attempt_vote(td_t *td);
-void  td_set_counters(td_t *td, int count1, int count2);
-int   td_get_counter1(td_t *td);
-int   td_get_counter2(td_t *td);
+void  td_wait(td_t *td);
+void  td_wake(td_t *td, int proc);
+void  td_set_counters(td_t *td, uint64_t count1, uint64_t count2);
+uint64_t td_get_counter1(td_t *td);
+uint64_t td_get_counter2(td_t *td);
 
 #endif /* __TERMINATION_H__ */
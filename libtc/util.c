@@ -141,3 +141,38 @@ int gtc_lvl_dbg_eprintf(int lvl, const char *format, ...) {
   }
   return ret;
 }
+
+
+
+/**
+ *  gtc_map_peers - find which PEs' copies of a symmetric object we can load/store directly.
+ *    Collective call.  Setting GTC_NODE_LOCAL=0 turns the direct mappings off.
+ *    @param sym   symmetric object
+ *    @param peers array of shmem_n_pes() pointers, set to the local address of each PE's
+ *                 copy of sym or NULL if it has to be reached with RMA
+ *    @return 1 if every PE maps every other PE's copy (all PEs share one node), else 0
+ */
+int gtc_map_peers(void *sym, void **peers) {
+  char *env = getenv("GTC_NODE_LOCAL");
+  int  *all, *allmin;
+  int   enabled = !env || atoi(env);
+  int   ret;
+
+  all    = gtc_shmem_calloc(1, sizeof(int));
+  allmin = gtc_shmem_calloc(1, sizeof(int));
+
+  *all = enabled;
+  for (int p = 0; p < shmem_n_pes(); p++) {
+    peers[p] = enabled ? shmem_ptr(sym, p) : NULL;
+    if (!peers[p])
+      *all = 0;
+  }
+
+  // atomics can only go through the mapping if nobody is using NIC atomics on the same words
+  shmem_min_reduce(SHMEM_TEAM_WORLD, allmin, all, 1);
+  ret = *allmin;
+
+  shmem_free(all);
+  shmem_free(allmin);
+  return ret;
+}
@@ -0,0 +1,309 @@
+/*********************************************************************/
+/*                                                                   */
+/*  victim.c - scioto steal victim sets and target selection         */
+/*    (c) 2021 see COPYRIGHT in top-level                            */
+/*                                                                   */
+/*********************************************************************/
+#define _GNU_SOURCE 1
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "tc.h"
+
+/*
+ * Victims that haven't been seen yet look like they have one task, so they are tried ahead
+ * of victims that were seen empty.
+ */
+#define GTC_VICTIM_LOAD_UNKNOWN 1
+
+
+/* xorshift64* step, cheaper than rand() and private to each collection */
+static inline uint64_t gtc_victim_rand(tc_t *tc) {
+  uint64_t x = tc->victim_rand;
+
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  tc->victim_rand = x;
+  return x * 0x2545F4914F6CDD1DULL;
+}
+
+
+/* set membership for victims we remember from earlier steals */
+static inline int gtc_victim_in_set(tc_t *tc, gtc_victim_set_t *set, int v) {
+  if (v < 0 || v == _c->rank)
+    return 0;
+  if (set->scope == VICTIMS_ALL)
+    return 1;
+  return (set->scope == VICTIMS_NODE) == tc->on_node[v];
+}
+
+
+
+/*
+ * Random: uniform over the set with the C library generator.
+ */
+static int gtc_victim_random(tc_t *tc, gtc_victim_set_t *set) {
+  UNUSED(tc);
+  return set->pes[rand() % set->n];
+}
+
+
+/*
+ * Round robin: walk the set in order.
+ */
+static int gtc_victim_round_robin(tc_t *tc, gtc_victim_set_t *set) {
+  int v = set->pes[set->next];
+
+  UNUSED(tc);
+  set->next = (set->next + 1) % set->n;
+  return v;
+}
+
+
+/*
+ * Xorshift: uniform over the set with a per-collection xorshift generator.
+ */
+static int gtc_victim_xorshift(tc_t *tc, gtc_victim_set_t *set) {
+  return set->pes[gtc_victim_rand(tc) % set->n];
+}
+
+
+/*
+ * Permutation: visit every victim in the set once, in a random order, before any
+ * victim is picked again.  The set is reshuffled in place at the start of each pass.
+ */
+static int gtc_victim_permutation(tc_t *tc, gtc_victim_set_t *set) {
+  int v;
+
+  if (set->next == 0) {
+    for (int i = set->n - 1; i > 0; i--) {
+      int j = gtc_victim_rand(tc) % (i + 1);
+      v            = set->pes[i];
+      set->pes[i]  = set->pes[j];
+      set->pes[j]  = v;
+    }
+  }
+
+  v = set->pes[set->next];
+  set->next = (set->next + 1) % set->n;
+  return v;
+}
+
+
+/*
+ * Sticky: go back to the last victim we stole from until it comes up empty,
+ * otherwise pick at random.
+ */
+static int gtc_victim_sticky(tc_t *tc, gtc_victim_set_t *set) {
+  if (gtc_victim_in_set(tc, set, tc->sticky_victim))
+    return tc->sticky_victim;
+  return gtc_victim_xorshift(tc, set);
+}
+
+
+/*
+ * Two choice: pick two victims at random and take the one whose queue looked fuller the
+ * last time we saw it.  Queue sizes come from steal metadata probes and steal results, no
+ * extra communication is done here.
+ */
+static int gtc_victim_two_choice(tc_t *tc, gtc_victim_set_t *set) {
+  int a = gtc_victim_xorshift(tc, set);
+  int b = gtc_victim_xorshift(tc, set);
+
+  return tc->victim_load[b] > tc->victim_load[a] ? b : a;
+}
+
+
+
+/**
+ * gtc_victim_policy - look up the target selection policy for a target_select_e value
+ *
+ * @param target_selection one of target_select_e
+ * @return policy function, NULL if unknown
+ */
+gtc_victim_policy_t gtc_victim_policy(int target_selection) {
+  switch (target_selection) {
+    case TARGET_RANDOM:      return gtc_victim_random;
+    case TARGET_ROUND_ROBIN: return gtc_victim_round_robin;
+    case TARGET_XORSHIFT:    return gtc_victim_xorshift;
+    case TARGET_PERMUTATION: return gtc_victim_permutation;
+    case TARGET_STICKY:      return gtc_victim_sticky;
+    case TARGET_TWO_CHOICE:  return gtc_victim_two_choice;
+    default:                 return NULL;
+  }
+}
+
+
+
+/**
+ * gtc_victim_coin - biased coin flip.  Random target selection keeps using rand(), the other
+ *   policies use the per-collection generator.
+ *
+ * @param tc  task collection
+ * @param pct chance of heads, in percent
+ * @return 1 with probability pct/100, 0 otherwise
+ */
+int gtc_victim_coin(tc_t *tc, int pct) {
+  if (tc->ldbal_cfg.target_selection == TARGET_RANDOM)
+    return rand() % 100 < pct;
+  return gtc_victim_rand(tc) % 100 < (uint64_t)pct;
+}
+
+
+
+/**
+ * gtc_victims_create - build the victim sets for a task collection.  On-node PEs are
+ *   found with SHMEM_TEAM_SHARED.
+ *
+ * @param tc task collection
+ */
+void gtc_victims_create(tc_t *tc) {
+  struct timespec t = gtc_get_wtime();
+  int nnode = shmem_team_n_pes(SHMEM_TEAM_SHARED);
+
+  tc->on_node     = gtc_calloc(_c->size, sizeof(uint8_t));
+  tc->victim_load = gtc_malloc(_c->size * sizeof(int));
+
+  for (int i = 0; i < nnode; i++) {
+    int p = shmem_team_translate_pe(SHMEM_TEAM_SHARED, i, SHMEM_TEAM_WORLD);
+    if (p >= 0 && p != _c->rank)
+      tc->on_node[p] = 1;
+  }
+
+  for (int s = 0; s < VICTIMS_NSCOPES; s++) {
+    tc->victims[s].pes   = gtc_malloc(_c->size * sizeof(int));
+    tc->victims[s].n     = 0;
+    tc->victims[s].scope = s;
+  }
+
+  // round robin walks the PEs after us in order
+  for (int i = 1; i < _c->size; i++) {
+    int p = (_c->rank + i) % _c->size;
+
+    tc->victims[VICTIMS_ALL].pes[tc->victims[VICTIMS_ALL].n++] = p;
+    if (tc->on_node[p])
+      tc->victims[VICTIMS_NODE].pes[tc->victims[VICTIMS_NODE].n++] = p;
+    else
+      tc->victims[VICTIMS_REMOTE].pes[tc->victims[VICTIMS_REMOTE].n++] = p;
+  }
+
+  tc->victim_rand = ((uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec) ^ ((uint64_t)(_c->rank + 1) * 0x9E3779B97F4A7C15ULL);
+  if (tc->victim_rand == 0)
+    tc->victim_rand = 1;
+
+  gtc_victims_reset(tc);
+}
+
+
+
+/**
+ * gtc_victims_destroy - free the victim sets
+ *
+ * @param tc task collection
+ */
+void gtc_victims_destroy(tc_t *tc) {
+  for (int s = 0; s < VICTIMS_NSCOPES; s++)
+    free(tc->victims[s].pes);
+  free(tc->on_node);
+  free(tc->victim_load);
+}
+
+
+
+/**
+ * gtc_victims_reset - forget what we have learned about other PEs' queues
+ *
+ * @param tc task collection
+ */
+void gtc_victims_reset(tc_t *tc) {
+  for (int s = 0; s < VICTIMS_NSCOPES; s++)
+    tc->victims[s].next = 0;
+  for (int p = 0; p < _c->size; p++)
+    tc->victim_load[p] = GTC_VICTIM_LOAD_UNKNOWN;
+  tc->sticky_victim = -1;
+}
+
+
+
+/**
+ * gtc_victim_observe - record the shared queue size seen on a victim by a metadata probe
+ *
+ * @param tc   task collection
+ * @param v    victim
+ * @param size number of tasks available to steal
+ */
+void gtc_victim_observe(tc_t *tc, int v, int size) {
+  tc->victim_load[v] = size;
+  if (size == 0 && tc->sticky_victim == v)
+    tc->sticky_victim = -1;
+}
+
+
+
+/**
+ * gtc_victim_stolen - record the result of a steal.  Steal-half takes about as many tasks
+ *   as it leaves behind, so the number stolen stands in for the victim's remaining load.
+ *
+ * @param tc      task collection
+ * @param v       victim
+ * @param nstolen number of tasks stolen, 0 if the victim had none
+ */
+void gtc_victim_stolen(tc_t *tc, int v, int nstolen) {
+  tc->victim_load[v] = nstolen;
+  if (nstolen > 0)
+    tc->sticky_victim = v;
+  else if (tc->sticky_victim == v)
+    tc->sticky_victim = -1;
+}
+
+
+
+/**
+ * gtc_probe_victims - probe probe_width victims at once and pick the one with the most work.
+ *   Levels are probed from the highest priority down, stopping at the first level where
+ *   somebody has work.
+ *
+ * @param gtc   task collection
+ * @param state target selector state, last_target is set to the victim picked
+ * @param level set to the priority level the victim has work at
+ * @param size  set to the number of tasks the victim had available
+ * @return victim to steal from, -1 if none of the probed victims had work
+ */
+int gtc_probe_victims(gtc_t gtc, gtc_vs_state_t *state, int *level, int *size) {
+  GTC_ENTRY();
+  tc_t *tc = gtc_lookup(gtc);
+  int   procs[GTC_MAX_PROBE_WIDTH], sizes[GTC_MAX_PROBE_WIDTH];
+  int   n = 0, v = -1;
+
+  // candidates come from the selection policy, duplicates are probed once
+  for (int i = 0; i < tc->ldbal_cfg.probe_width; i++) {
+    int p = gtc_select_target(gtc, state), j;
+
+    for (j = 0; j < n && procs[j] != p; j++)
+      ;
+    if (j == n)
+      procs[n++] = p;
+  }
+
+  *size = 0;
+  for (int l = tc->npriorities-1; l >= 0 && v < 0; l--) {
+    tc->rcb.probe_n(tc->prio_rb[l], procs, n, sizes);
+    tc->ct.probes += n;
+    tc->ct.probe_rounds++;
+
+    for (int i = 0; i < n; i++) {
+      gtc_victim_observe(tc, procs[i], sizes[i]);
+      if (sizes[i] > *size) {
+        *size  = sizes[i];
+        *level = l;
+        v      = procs[i];
+      }
+    }
+  }
+
+  state->last_target = (v >= 0) ? v : procs[0];
+  GTC_EXIT(v);
+}
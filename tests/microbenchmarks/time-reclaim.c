@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+
+#include <tc.h>
+#include <saws_shrb.h>
+
+/*
+ * SAWS reclaim cost under heavy stealing.
+ *
+ * Process 0 fills its queue and keeps releasing it with a chunked claim schedule, so every
+ * epoch has many steals, while calling the reclaim step of gtc_progress_saws() in a loop.
+ * Everyone else steals from process 0 until it runs dry.  Reports the per-call cost for
+ * each completion mode.
+ */
+
+#define NREPS    100
+#define QSIZE    8192
+#define CHUNK    8
+
+char *modes[2] = { "counter", "scan" };
+
+int main(int argc, char **argv) {
+  int arg, nreps = NREPS, qsize = QSIZE, chunk = CHUNK;
+  tc_t tc;
+  saws_shrb_t *rb;
+  int64_t *tasks, *buf;
+  int *done;
+  tc_timer_t time;
+  uint64_t ncalls;
+
+  setbuf(stdout, NULL);
+
+  while ((arg = getopt(argc, argv, "hn:q:c:")) != -1) {
+    switch (arg) {
+      case 'n':
+        nreps = atoi(optarg);
+        break;
+      case 'q':
+        qsize = atoi(optarg);
+        break;
+      case 'c':
+        chunk = atoi(optarg);
+        break;
+      case 'h':
+        eprintf("  usage: time-reclaim [-n nreps] [-q queue size] [-c steal chunk size]\n");
+        break;
+    }
+  }
+
+  gtc_init();
+
+  if (_c->size < 2) {
+    eprintf("requires at least two processes\n");
+    exit(1);
+  }
+
+  memset(&tc, 0, sizeof(tc_t));
+  tc.timers = calloc(1, sizeof(tc_timers_t));
+  tc.ldbal_cfg.steal_method = STEAL_CHUNK;
+  tc.ldbal_cfg.chunk_size   = chunk;
+
+  rb    = saws_shrb_create(sizeof(int64_t), qsize, &tc);
+  buf   = saws_shrb_malloc(qsize, sizeof(int64_t));
+  tasks = calloc(qsize, sizeof(int64_t));
+  done  = gtc_shmem_calloc(1, sizeof(int));
+
+  eprintf("\nSAWS reclaim timing: %d procs, %d reps, queue %d, chunk %d\n", _c->size, nreps, qsize, chunk);
+
+  for (int mode = SAWSCompletionCounter; mode <= SAWSCompletionScan; mode++) {
+    TC_INIT_ATIMER(time);
+    ncalls = 0;
+
+    for (int rep = 0; rep < nreps; rep++) {
+      saws_shrb_reset(rb);
+      rb->completion = mode;
+      if (_c->rank == 0) {
+        saws_shrb_push_n_head(rb, rb->procid, tasks, qsize);
+        saws_shrb_release(rb);
+      }
+      shmem_barrier_all();
+
+      if (_c->rank == 0) {
+        while (!saws_shrb_isempty(rb)) {
+          TC_START_ATIMER(time);
+          saws_shrb_reclaim_space(rb);
+          TC_STOP_ATIMER(time);
+          ncalls++;
+          saws_shrb_release(rb);
+        }
+        for (int i = 1; i < _c->size; i++)
+          shmem_int_atomic_set(done, 1, i);
+      } else {
+        while (!shmem_int_atomic_fetch(done, _c->rank))
+          saws_shrb_pop_n_tail(rb, 0, chunk, buf, STEAL_CHUNK);
+      }
+      shmem_barrier_all();
+      *done = 0;
+      shmem_barrier_all();
+    }
+
+    eprintf("  %-8s %10"PRIu64" reclaim calls %8.3f usec/call\n", modes[mode], ncalls,
+        ncalls ? TC_READ_ATIMER_USEC(time)/(double)ncalls : 0.0);
+  }
+
+  free(tasks);
+  shmem_free(buf);
+  shmem_free(done);
+  saws_shrb_destroy(rb);
+
+  gtc_fini();
+  return 0;
+}
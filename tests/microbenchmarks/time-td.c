@@ -12,9 +12,10 @@ int main(int argc, char **argv)
 {
   int i, comm_size, comm_rank, NITER = 1;
   int NBARRIER = 1000, ret = 0;
-  static double t_td = 0.0;
+  static double t_td[2] = { 0.0, 0.0 };
   static double t_armci_barrier = 0.0;
-  static double t_td_max, t_armci_max;
+  static double t_td_max[2], t_armci_max;
+  static uint64_t waves[2], waits[2], waits_sum[2];
   td_t **tds;
   tc_timer_t tdtime, barriertime;
 
@@ -43,25 +44,41 @@ int main(int argc, char **argv)
   if (comm_rank == 0) printf("Termination Detection uBench -- NITER = %d, NPROC = %d\n\n", NITER, comm_size);
 
 
-  if (comm_rank == 0) printf("Performing termination detection timing...\n");
-  fflush(NULL);
-  tds = calloc(NITER, sizeof(td_t));
-  for (int i=0; i<NITER; i++) 
-    tds[i] = td_create();
-  shmem_barrier_all();
-
-  //t_td = MPI_Wtime();
-  TC_START_ATIMER(tdtime);
-  for (i = 0; i < NITER; i++) {
-    while (!td_attempt_vote(tds[i]));
-    // MPI_Barrier(MPI_COMM_WORLD); // Prevent from overlapping
+  for (int mode = TD_POLL; mode <= TD_EVENT; mode++) {
+    if (comm_rank == 0) printf("Performing termination detection timing (%s)...\n", mode == TD_POLL ? "poll" : "event");
+    fflush(NULL);
+    tds = calloc(NITER, sizeof(td_t));
+    for (int i=0; i<NITER; i++) {
+      tds[i] = td_create();
+      tds[i]->mode = mode;
+    }
     shmem_barrier_all();
+
+    //t_td = MPI_Wtime();
+    TC_INIT_ATIMER(tdtime);
+    TC_START_ATIMER(tdtime);
+    for (i = 0; i < NITER; i++) {
+      while (!td_attempt_vote(tds[i]))
+        td_wait(tds[i]); // returns right away when polling
+      // MPI_Barrier(MPI_COMM_WORLD); // Prevent from overlapping
+      shmem_barrier_all();
+    }
+    //t_td = MPI_Wtime() - t_td;
+    TC_STOP_ATIMER(tdtime);
+
+    // the root counts the waves it took to detect termination
+    waves[mode] = 0;
+    waits[mode] = 0;
+    for (int i=0; i<NITER; i++) {
+      waves[mode] += tds[i]->num_attempts;
+      waits[mode] += tds[i]->num_waits;
+    }
+
+    for (int i=0; i<NITER; i++)
+      td_destroy(tds[i]);
+    free(tds);
+    t_td[mode] = TC_READ_ATIMER_MSEC(tdtime);
   }
-  //t_td = MPI_Wtime() - t_td;
-  TC_STOP_ATIMER(tdtime);
-  for (int i=0; i<NITER; i++)
-    td_destroy(tds[i]);
-  free(tds);
 
 
   if (comm_rank == 0) printf("Performing shmem_barrier_all() timing...\n");
@@ -76,20 +93,24 @@ int main(int argc, char **argv)
   //t_armci_barrier = MPI_Wtime() - t_armci_barrier;
   TC_STOP_ATIMER(barriertime);
 
-  t_td            = TC_READ_ATIMER_MSEC(tdtime);
   t_armci_barrier = TC_READ_ATIMER_MSEC(barriertime);
 
-  shmem_max_reduce(SHMEM_TEAM_WORLD, &t_td_max, &t_td, 1);
+  shmem_max_reduce(SHMEM_TEAM_WORLD, t_td_max, t_td, 2);
+  shmem_sum_reduce(SHMEM_TEAM_WORLD, waits_sum, waits, 2);
   shmem_max_reduce(SHMEM_TEAM_WORLD, &t_armci_max, &t_armci_barrier, 1);
   //gtc_reduce(&t_td, &t_td_max,               GtcReduceOpMax, DoubleType, 1);
   //gtc_reduce(&t_armci_barrier, &t_armci_max, GtcReduceOpMax, DoubleType, 1);
 
   double perbarrier = t_armci_max / (double)NBARRIER;
-  double final = t_td_max - (perbarrier * (double)NITER);
   if (comm_rank == 0) {
-    printf("\nResults: %0.9f ms/td td+barr: %0.9f ms/td, barr: %0.9f ms/barrier\n",
-        final/NITER, t_td_max/NITER, t_armci_max/NBARRIER);
-    printf("%04d   %0.9f  %0.9f  %0.9f\n", _c->size, final/NITER, t_td_max/NITER, t_armci_max/NBARRIER);
+    for (int mode = TD_POLL; mode <= TD_EVENT; mode++) {
+      double final = t_td_max[mode] - (perbarrier * (double)NITER);
+      printf("\nResults (%s): %0.9f ms/td td+barr: %0.9f ms/td, barr: %0.9f ms/barrier, %.2f waves/td, %.2f waits/td/PE\n",
+          mode == TD_POLL ? "poll" : "event", final/NITER, t_td_max[mode]/NITER, t_armci_max/NBARRIER,
+          waves[mode]/(double)NITER, waits_sum[mode]/(double)(NITER*comm_size));
+      printf("%04d %-5s %0.9f  %0.9f  %0.9f  %6.2f\n", _c->size, mode == TD_POLL ? "poll" : "event",
+          final/NITER, t_td_max[mode]/NITER, t_armci_max/NBARRIER, waves[mode]/(double)NITER);
+    }
   }
 
 done:
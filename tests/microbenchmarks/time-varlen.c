@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+
+#include <tc.h>
+#include <saws_shrb.h>
+
+/*
+ * SAWS steal cost with mixed element sizes.
+ *
+ * Process 0 fills its queue with a mix of small and large elements and keeps releasing it,
+ * everyone else steals into their own queue and drains it.  This runs once with fixed slots
+ * and once with variable-length slots (GTC_QUEUE_VARLEN) and reports the time per steal and
+ * the bytes moved per stolen element for each.
+ */
+
+#define NREPS    20
+#define QSIZE    8192
+#define SMALL    16
+#define LARGE    1024
+#define PLARGE   10
+
+typedef struct {
+  int32_t len;     // bytes used by this element, header included
+  int32_t id;
+  char    body[0]; // last byte of the body is (char)id
+} elem_t;
+
+char *modes[2] = { "fixed", "varlen" };
+int   small = SMALL, large = LARGE, plarge = PLARGE;
+
+static int elem_len(void *e) {
+  return ((elem_t *)e)->len;
+}
+
+static int expected_len(int id) {
+  return sizeof(elem_t) + ((id % 100 < plarge) ? large : small);
+}
+
+int main(int argc, char **argv) {
+  int arg, nreps = NREPS, qsize = QSIZE;
+  tc_t tc;
+  saws_shrb_t *rb;
+  elem_t *e, *buf;
+  int *done, n;
+  double *stats, *sums;
+  uint64_t errors = 0;
+  tc_timer_t time;
+
+  setbuf(stdout, NULL);
+
+  while ((arg = getopt(argc, argv, "hn:q:s:l:p:")) != -1) {
+    switch (arg) {
+      case 'n':
+        nreps = atoi(optarg);
+        break;
+      case 'q':
+        qsize = atoi(optarg);
+        break;
+      case 's':
+        small = atoi(optarg);
+        break;
+      case 'l':
+        large = atoi(optarg);
+        break;
+      case 'p':
+        plarge = atoi(optarg);
+        break;
+      case 'h':
+        eprintf("  usage: time-varlen [-n nreps] [-q queue size] [-s small body] [-l large body] [-p percent large]\n");
+        break;
+    }
+  }
+
+  gtc_init();
+
+  if (_c->size < 2) {
+    eprintf("requires at least two processes\n");
+    exit(1);
+  }
+
+  memset(&tc, 0, sizeof(tc_t));
+  tc.timers = calloc(1, sizeof(tc_timers_t));
+  tc.ldbal_cfg.steal_method = STEAL_HALF;
+
+  e     = calloc(1, sizeof(elem_t) + large);
+  buf   = calloc(1, sizeof(elem_t) + large);
+  done  = gtc_shmem_calloc(1, sizeof(int));
+  stats = gtc_shmem_calloc(4, sizeof(double));
+  sums  = gtc_shmem_calloc(4, sizeof(double));
+
+  eprintf("\nSAWS mixed-size steals: %d procs, %d reps, queue %d, %d%% of bodies %d bytes, rest %d bytes\n",
+      _c->size, nreps, qsize, plarge, large, small);
+
+  for (int mode = 0; mode <= 1; mode++) {
+    setenv("GTC_QUEUE_VARLEN", mode ? "1" : "0", 1);
+    rb = saws_shrb_create(sizeof(elem_t) + large, qsize, &tc);
+    rb->elem_len = elem_len;
+    TC_INIT_ATIMER(time);
+    memset(stats, 0, 4*sizeof(double));
+
+    for (int rep = 0; rep < nreps; rep++) {
+      saws_shrb_reset(rb);
+      if (_c->rank == 0) {
+        for (int i = 0; i < qsize; i++) {
+          e->id  = i;
+          e->len = expected_len(i);
+          ((char *)e)[e->len - 1] = (char)i;
+          saws_shrb_push_head(rb, rb->procid, e, e->len);
+        }
+        saws_shrb_release(rb);
+      }
+      shmem_barrier_all();
+
+      if (_c->rank == 0) {
+        while (!saws_shrb_isempty(rb)) {
+          saws_shrb_reclaim_space(rb);
+          saws_shrb_release(rb);
+        }
+        for (int i = 1; i < _c->size; i++)
+          shmem_int_atomic_set(done, 1, i);
+      } else {
+        while (!shmem_int_atomic_fetch(done, _c->rank)) {
+          TC_START_ATIMER(time);
+          n = saws_shrb_steal_n_tail(rb, 0, 1, STEAL_HALF);
+          TC_STOP_ATIMER(time);
+          if (n <= 0)
+            continue;
+          stats[0] += 1;
+          stats[1] += n;
+          while (saws_shrb_pop_head(rb, rb->procid, buf))
+            if (buf->len != expected_len(buf->id) || ((char *)buf)[buf->len - 1] != (char)buf->id)
+              errors++;
+        }
+      }
+      shmem_barrier_all();
+      *done = 0;
+      shmem_barrier_all();
+    }
+
+    stats[2] = rb->stats->nxfer;
+    stats[3] = TC_READ_ATIMER_USEC(time);
+    shmem_sum_reduce(SHMEM_TEAM_WORLD, sums, stats, 4);
+
+    eprintf("  %-8s %8.0f steals %10.0f elements %8.3f usec/steal %8.1f bytes/element\n", modes[mode],
+        sums[0], sums[1], sums[0] ? sums[3]/sums[0] : 0.0, sums[1] ? sums[2]/sums[1] : 0.0);
+
+    saws_shrb_destroy(rb);
+  }
+
+  if (errors)
+    printf("%d: %"PRIu64" corrupted elements\n", _c->rank, errors);
+
+  free(e);
+  free(buf);
+  shmem_free(done);
+  shmem_free(stats);
+  shmem_free(sums);
+
+  gtc_fini();
+  return errors != 0;
+}
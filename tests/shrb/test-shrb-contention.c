@@ -1,52 +1,151 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
-#include <shr_ring.h>
+#include <tc.h>
 
-#define NUM 1000
+/*
+ * Owner-side cost of queue operations while thieves hammer the queue metadata.
+ *
+ * Process 0 keeps part of its queue public and times push_head()/pop_head() pairs on the
+ * local end, first with everyone else idle and then while everyone else repeatedly steals from
+ * its tail.  Any slowdown in the second phase comes from thieves' remote operations landing on
+ * the cache lines the owner touches.  Build with -DSDC for the SDC queue.
+ */
+
+#ifdef SDC
+#include <sdc_shr_ring.h>
+#define QNAME                 "SDC"
+#define shrb_t                sdc_shrb_t
+#define shrb_create           sdc_shrb_create
+#define shrb_destroy          sdc_shrb_destroy
+#define shrb_reset            sdc_shrb_reset
+#define shrb_push_head        sdc_shrb_push_head
+#define shrb_pop_head         sdc_shrb_pop_head
+#define shrb_pop_n_tail       sdc_shrb_pop_n_tail
+#define shrb_release          sdc_shrb_release
+#define shrb_reclaim_space    sdc_shrb_reclaim_space
+#define shrb_local_size       sdc_shrb_local_size
+#else
+#include <saws_shrb.h>
+#define QNAME                 "SAWS"
+#define shrb_t                saws_shrb_t
+#define shrb_create           saws_shrb_create
+#define shrb_destroy          saws_shrb_destroy
+#define shrb_reset            saws_shrb_reset
+#define shrb_push_head        saws_shrb_push_head
+#define shrb_pop_head         saws_shrb_pop_head
+#define shrb_pop_n_tail       saws_shrb_pop_n_tail
+#define shrb_release          saws_shrb_release
+#define shrb_reclaim_space    saws_shrb_reclaim_space
+#define shrb_local_size       saws_shrb_local_size
+#endif
+
+#define NUM      1000000
+#define QSIZE    8192
+#define CHUNK    1
+#define BLOCK    256     // push/pop pairs between refills of the public portion
+
+char *phases[2] = { "quiet", "contended" };
 
 int main(int argc, char **argv, char **envp) {
-    int errors = 0;
-    int i;
+    int arg, num = NUM, qsize = QSIZE, chunk = CHUNK;
+    tc_t tc;
     shrb_t *rb;
-    int x;
-    int digits[NUM];
+    int x, *buf, *done;
+    uint64_t *attempts, *nattempts;
+    double usec[2];
+    tc_timer_t time;
 
-    // just need this to setup Portals world
-    gtc_init();
+    setbuf(stdout, NULL);
 
-    rb = shrb_create(sizeof(int), 100000);
+    while ((arg = getopt(argc, argv, "hn:q:c:")) != -1) {
+        switch (arg) {
+            case 'n':
+                num = atoi(optarg);
+                break;
+            case 'q':
+                qsize = atoi(optarg);
+                break;
+            case 'c':
+                chunk = atoi(optarg);
+                break;
+            case 'h':
+                eprintf("  usage: test-shrb-contention [-n push/pop pairs] [-q queue size] [-c steal chunk size]\n");
+                break;
+        }
+    }
 
-    if (rb->procid == 0) printf("\nPortals Shared ring buffer test: Started with %d threads\n\n", rb->nproc);
-    if (rb->procid == 0) printf("TEST: everyone push_head() onto thread 0\n");
+    gtc_init();
 
-    // Push everything onto processor 0
-    for (i = 0; i < NUM; i++) {
-        //shrb_lock(rb, 0);
-        shrb_push_head(rb, 0, &i, sizeof(int));
-        //shrb_unlock(rb, 0);
+    if (_c->size < 2) {
+        eprintf("requires at least two processes\n");
+        exit(1);
     }
 
-    gtc_barrier();
+    memset(&tc, 0, sizeof(tc_t));
+    tc.timers = calloc(1, sizeof(tc_timers_t));
+    tc.ldbal_cfg.steal_method = STEAL_CHUNK;
+    tc.ldbal_cfg.chunk_size   = chunk;
 
-    for (i = 0; i < NUM; i++) digits[i] = 0;
+    rb        = shrb_create(sizeof(int), qsize, &tc);
+    buf       = calloc(chunk, sizeof(int));
+    done      = gtc_shmem_calloc(1, sizeof(int));
+    attempts  = gtc_shmem_calloc(1, sizeof(uint64_t));
+    nattempts = gtc_shmem_calloc(1, sizeof(uint64_t));
 
-    while (rb->procid == 0 && shrb_pop_head(rb, 0, &x)) {
-        //printf(" -- %d: Got digit %d\n", rb->procid, x);
-        digits[x]++;
-    }
+    eprintf("\n%s queue contention: %d procs, %d push/pop pairs, queue %d, steal chunk %d\n",
+        QNAME, _c->size, num, qsize, chunk);
+
+    for (int phase = 0; phase <= 1; phase++) {
+        TC_INIT_ATIMER(time);
+        *attempts = 0;
+        shrb_reset(rb);
+        shmem_barrier_all();
+
+        if (_c->rank == 0) {
+            for (int i = 0; i < num; i += BLOCK) {
+                // keep some work public so thieves have something to claim
+                shrb_reclaim_space(rb);
+                for (x = 0; shrb_local_size(rb) < qsize/2; x++)
+                    shrb_push_head(rb, rb->procid, &x, sizeof(int));
+                shrb_release(rb);
 
-    gtc_barrier();
+                TC_START_ATIMER(time);
+                for (int j = 0; j < BLOCK; j++) {
+                    x = i + j;
+                    shrb_push_head(rb, rb->procid, &x, sizeof(int));
+                    shrb_pop_head(rb, rb->procid, &x);
+                }
+                TC_STOP_ATIMER(time);
+            }
+            for (int i = 1; i < _c->size; i++)
+                shmem_int_atomic_set(done, 1, i);
 
-    for (i = 0; rb->procid == 0 && i < NUM; i++) {
-        if (digits[i] != rb->nproc) {
-            printf(" -- %d: Error, count for %d is %d, expected %d\n", rb->procid, i, digits[i], rb->nproc);
-            errors++;
+        } else if (phase == 1) {
+            while (!shmem_int_atomic_fetch(done, _c->rank)) {
+                shrb_pop_n_tail(rb, 0, chunk, buf, STEAL_CHUNK);
+                (*attempts)++;
+            }
         }
+
+        shmem_barrier_all();
+        *done = 0;
+        shmem_sum_reduce(SHMEM_TEAM_WORLD, nattempts, attempts, 1);
+
+        usec[phase] = TC_READ_ATIMER_USEC(time) / (double)num;
+        eprintf("  %-10s %8.4f usec/pair %12"PRIu64" steal attempts\n", phases[phase], usec[phase], *nattempts);
     }
 
+    eprintf("  slowdown   %8.2fx\n", usec[0] > 0 ? usec[1]/usec[0] : 0.0);
+
+    free(buf);
+    shmem_free(done);
+    shmem_free(attempts);
+    shmem_free(nattempts);
     shrb_destroy(rb);
 
-    if (rb->procid == 0) printf("Test finished: %d errors.\n", errors);
+    gtc_fini();
     return 0;
 }
@@ -20,7 +20,7 @@ int main(int argc, char **argv) {
   synch_mutex_init(&mutex);
 
   if (shmem_my_pe() == 0) {
-    printf("Mutex test starting on %d processes\n", shmem_n_pes());
+    printf("Mutex test starting on %d processes with %s\n", shmem_n_pes(), synch_mutex_name());
     fflush(stdout);
   }
 
@@ -88,6 +88,7 @@ int main(int argc, char **argv) {
   if (shmem_my_pe() == 0)
     printf("Mutex test completed %d mutex ops in %f sec\n", NITER*shmem_n_pes(), TC_READ_ATIMER_SEC(timer));
 
+  synch_mutex_destroy(&mutex);
   gtc_fini();
   return 0;
 }
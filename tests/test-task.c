@@ -69,28 +69,48 @@ int main(int argc, char **argv)
   int   i, arg;
   gtc_t gtc;
   gtc_qtype_t qtype = GtcQueueSAWS;
+  gtc_ldbal_cfg_t cfg;
   int num_tasks = NUM_TASKS;
+  int qsize = 0;
 
   setenv("SHMEM_BACKTRACE", "gdb", 1);
   setenv("SHMEM_TRAP_ON_ABORT", "1", 1);
 
   // printf("(%d) _c->size: %d\n", _c->rank, _c->size);
 
-  while ((arg = getopt(argc, argv, "BHNn:t:")) != -1) {
+  gtc_ldbal_cfg_init(&cfg);
+
+  while ((arg = getopt(argc, argv, "ABHLNWc:n:q:t:")) != -1) {
     switch (arg) {
+      case 'A':
+        cfg.steal_method = STEAL_ALL;
+        break;
       case 'B':
         qtype = GtcQueueSDC;
         break;
+      case 'L':
+        qtype = GtcQueueSDCLF;
+        break;
+      case 'W':
+        cfg.steal_method = STEAL_WORK;
+        break;
+      case 'c':
+        cfg.steal_method = STEAL_CHUNK;
+        cfg.chunk_size   = atoi(optarg);
+        break;
       case 'n':
         num_tasks = atoi(optarg);
         break;
+      case 'q':
+        qsize = atoi(optarg); // smaller than -n exercises the queue overflow spill
+        break;
       case 't':
         gtimeout = atoi(optarg);
         break;
     }
   }
 
-  gtc = gtc_create(sizeof(mytask_t), 10, num_tasks, NULL, qtype);
+  gtc = gtc_create(sizeof(mytask_t), 10, qsize ? qsize : num_tasks, &cfg, qtype);
 
   mythread = _c->rank;
   nthreads = _c->size;
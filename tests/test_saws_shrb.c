@@ -8,6 +8,7 @@
 
 #define GTC_TEST_DEBUG   0
 #define NUM    16
+#define LARGEQ ((1 << 21) + 5)  /* > 2^20 slots, needs the wide steal_val layout */
 #define TAILTARGET  (rb->procid + 1) % rb->nproc /* round robin */
 #define HEADTARGET  rb->procid               /* local only */
 #define root (rb->procid == 0)
@@ -56,6 +57,7 @@ void test_release() {
   tc_t tc;
 
   memset(&tc, 0, sizeof(tc_t));
+  tc.timers = calloc(1, sizeof(tc_timers_t));
 
     eprintf("\nUNIT TEST: saws_shrb_release()\n");
     saws_shrb_t *rb; 
@@ -76,7 +78,7 @@ void test_release() {
         uint64_t size = saws_shrb_shared_size(rb);
         shmem_fence();
         shmem_barrier_all();
-        assert(((rb->steal_val >> 19) & 0x00000000007FFFF) == size);
+        assert(saws_stealval_itasks(rb->steal_val) == size);
 
         // steal all the tasks
         while(saws_shrb_pop_tail(rb, TAILTARGET, x))    ;
@@ -96,6 +98,7 @@ void test_reacquire() {
   tc_t tc;
 
   memset(&tc, 0, sizeof(tc_t));
+  tc.timers = calloc(1, sizeof(tc_timers_t));
 
     eprintf("\nUNIT TEST: saws_shrb_reacquire()\n\n");
     
@@ -137,6 +140,7 @@ void test_steals() {
   tc_t tc;
 
   memset(&tc, 0, sizeof(tc_t));
+  tc.timers = calloc(1, sizeof(tc_timers_t));
 
     eprintf("\nUNIT TEST: saws_shrb_ pop_tail()\n\n");
 
@@ -174,7 +178,7 @@ void test_steals() {
 
         uint32_t count = 0;
         steals = shmem_atomic_fetch(&rb->steal_val, TAILTARGET);
-        int itasks = (steals >> 19) & 0x1F;
+        int itasks = saws_stealval_itasks((uint64_t)steals);
         shmem_barrier_all();
         
         while (saws_shrb_pop_tail(rb, TAILTARGET, x)) {
@@ -194,6 +198,66 @@ void test_steals() {
     }
 }
 
+void test_large_queue() {
+  tc_t tc;
+  saws_shrb_t *rb;
+  int64_t *y64, *x;
+  int64_t  size, n, total;
+
+  memset(&tc, 0, sizeof(tc_t));
+  tc.timers = calloc(1, sizeof(tc_timers_t));
+
+  eprintf("\nUNIT TEST: saws_shrb large queue (%d slots)\n\n", LARGEQ);
+
+  rb  = saws_shrb_create(sizeof(int64_t), LARGEQ, &tc);
+  x   = saws_shrb_malloc(LARGEQ, sizeof(int64_t));
+  y64 = calloc(LARGEQ, sizeof(int64_t));
+  for (int64_t i = 0; i < LARGEQ; i++)
+    y64[i] = i;
+
+  saws_shrb_push_n_head(rb, HEADTARGET, y64, LARGEQ);
+  saws_shrb_release(rb);
+  shmem_barrier_all();
+
+  // a single release is larger than the old 19-bit itasks field
+  size = saws_shrb_shared_size(rb);
+  assert(size == LARGEQ / 2 + LARGEQ % 2);
+  assert(size > (1 << 20));
+  assert(saws_stealval_itasks(rb->steal_val) == (uint64_t)size);
+  assert(saws_stealval_tail(rb->steal_val) == 0);
+  shmem_barrier_all();
+
+  // first steal takes half of the release, starting at the tail
+  n = saws_shrb_pop_tail(rb, TAILTARGET, x);
+  assert(n == size / 2);
+  for (int64_t i = 0; i < n; i++)
+    assert(x[i] == i);
+  shmem_barrier_all();
+
+  saws_shrb_reclaim_space(rb);
+  assert(rb->tail == n);
+  shmem_barrier_all();
+
+  // drain the rest of the release and make sure every task came across
+  total = n;
+  while ((n = saws_shrb_pop_tail(rb, TAILTARGET, x)) > 0) {
+    assert(x[0] == total);
+    total += n;
+  }
+  assert(total == size);
+  shmem_barrier_all();
+
+  saws_shrb_reclaim_space(rb);
+  assert(saws_shrb_shared_isempty(rb));
+  assert(saws_shrb_local_size(rb) == LARGEQ - size);
+  shmem_barrier_all();
+
+  free(y64);
+  shmem_free(x);
+  saws_shrb_destroy(rb);
+}
+
+
 void test_reclaim() {
 
     eprintf("\nUNIT TEST saws_shrb_reclaim()\n\n");
@@ -246,6 +310,8 @@ int main(int argc, char **argv, char **envp) {
 
     test_reacquire();
 
+    test_large_queue();
+
     //test_steals();
 
     //test_reclaim();